@@ -0,0 +1,127 @@
+#ifndef ACTION_EXECUTOR_HPP
+#define ACTION_EXECUTOR_HPP
+
+#include "singleton.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mavsdk/plugins/action/action.h>
+#include <mavsdk/plugins/telemetry/telemetry.h>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 动作执行阶段
+enum class ActionPhase : int
+{
+    IDLE,         // 空闲
+    SET_ALTITUDE, // 设置起飞高度
+    ARMING,       // 解锁
+    TAKING_OFF,   // 起飞
+    LANDING,      // 发送降落命令
+    WAIT_LANDED,  // 等待遥测确认着地
+    DISARMING,    // 上锁
+};
+
+// 动作执行结果
+struct ActionOutcome
+{
+    bool success = false; // 是否成功
+    std::string message;  // 结果说明（失败时包含失败阶段和原因）
+};
+
+typedef std::function<void(const ActionOutcome &)> ActionCallback; // 完成回调（在执行线程中调用）
+
+// 执行参数
+struct ActionExecutorParams
+{
+    double command_timeout_s = 10.0; // 单条命令等待应答的超时时间(s)
+    double land_timeout_s = 60.0;    // 降落命令发出后等待着地的超时时间(s)
+    double on_ground_hold_s = 1.0;   // 遥测持续报告着地该时间后才上锁(s)，避免触地弹跳时误判
+    double tick_hz = 20.0;           // 执行线程推进阶段的频率(Hz)
+};
+
+/**
+ * @brief 非阻塞动作执行器
+ *
+ * 起飞（设置高度 → 解锁 → 起飞）和降落（降落 → 等待着地 → 上锁）按阶段用 MAVSDK 的 *_async 接口发出，
+ * 调用者立即返回，通过 future 或完成回调获得结果；阶段由独立线程推进，控制线程在整个过程中保持原有频率。
+ * 上锁由遥测着地状态触发（landed_state 为 OnGround，飞控不报告时用 in_air），不再固定等待。
+ * 同一时刻只执行一个动作，忙时新的请求直接返回失败结果。
+ */
+class ActionExecutor
+{
+public:
+    ~ActionExecutor();
+
+    /**
+     * @brief 启动执行线程
+     * @param action MAVSDK 动作插件
+     * @param telemetry MAVSDK 遥测插件（用于判断着地）
+     * @param params 执行参数
+     * @return 启动成功返回true（已启动时返回false）
+     */
+    bool start(mavsdk::Action &action, mavsdk::Telemetry &telemetry, const ActionExecutorParams &params = ActionExecutorParams());
+    void stop();                              // 停止执行线程（进行中的动作以失败结束）
+    bool running() const { return running_; } // 执行线程是否在运行
+
+    /**
+     * @brief 解锁并起飞
+     * @param altitude_m 起飞高度(m)
+     * @param done 完成回调（可为空）
+     * @return 结果 future（忙时立即就绪且为失败）
+     */
+    std::shared_future<ActionOutcome> takeoff(float altitude_m, ActionCallback done = nullptr);
+
+    /**
+     * @brief 降落并在着地后上锁
+     * @param done 完成回调（可为空）
+     * @return 结果 future（忙时立即就绪且为失败）
+     */
+    std::shared_future<ActionOutcome> landAndDisarm(ActionCallback done = nullptr);
+
+    /**
+     * @brief 取消进行中的动作
+     *
+     * 结果以失败结束并立即回到空闲，迟到的命令应答被丢弃；不发出任何命令，飞行器保持当前模式，由调用者随后的命令接管。
+     */
+    void cancel();
+
+    bool busy() const { return phase_ != ActionPhase::IDLE; } // 是否有动作在执行
+    ActionPhase phase() const { return phase_; }               // 当前阶段
+    static std::string phaseToString(ActionPhase phase);       // 阶段名称
+
+private:
+    std::shared_future<ActionOutcome> submit(ActionPhase first, float altitude_m, ActionCallback done); // 提交动作
+    void workerLoop();                                                                                  // 执行线程主循环
+    bool step(int64_t now_ns, ActionOutcome &outcome);                                                  // 推进当前阶段，动作结束时返回true
+    void enter(ActionPhase phase, int64_t now_ns);                                                      // 进入阶段（命令由执行线程在锁外发出）
+    void sendCommand(ActionPhase phase, uint64_t id);                                                   // 发出阶段的异步命令（不持有 mutex_）
+
+    mavsdk::Action *action_ = nullptr;
+    mavsdk::Telemetry *telemetry_ = nullptr;
+    ActionExecutorParams params_;
+
+    mutable std::mutex mutex_;   // 保护以下动作状态
+    std::condition_variable cv_; // 提交动作时唤醒执行线程
+    std::atomic<ActionPhase> phase_{ActionPhase::IDLE}; // 当前阶段（写入时持有 mutex_）
+    float altitude_m_ = 0.0f;                           // 起飞高度
+    int64_t phase_start_ns_ = 0;                        // 进入当前阶段的时刻
+    int64_t on_ground_since_ns_ = 0;                    // 持续着地的起始时刻（0 表示未着地）
+    uint64_t command_id_ = 0;                           // 当前命令编号（丢弃过期命令的应答）
+    bool command_pending_ = false;                      // 当前阶段的命令是否待发出
+    bool command_done_ = false;                         // 当前命令是否已应答
+    mavsdk::Action::Result command_result_{};           // 当前命令的应答结果
+    std::promise<ActionOutcome> promise_;               // 当前动作的结果
+    ActionCallback callback_;                           // 当前动作的完成回调
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+typedef NormalSingleton<ActionExecutor> action_executor;
+
+#endif // ACTION_EXECUTOR_HPP
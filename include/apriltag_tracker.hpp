@@ -3,9 +3,21 @@
 
 #include "apriltag/apriltag.h"
 #include "apriltag/tag25h9.h"
+#include "camera_calibration.hpp"
+#include "camera_frame.hpp"
+#include "change_gate.hpp"
+#include "deadline_governor.hpp"
+#include "detector_profile.hpp"
+#include "landing_pad.hpp"
+#include "math_library.hpp"
 #include "singleton.hpp"
+#include "tag_detection.hpp"
+#include "tag_pose.hpp"
+#include "tiled_detector.hpp"
 
 #include <atomic>
+#include <cstdlib>
+#include <memory>
 #include <mutex>
 #include <opencv2/opencv.hpp>
 #include <thread>
@@ -15,16 +27,129 @@
 struct AprilTagData
 {
     bool iffind;                   // 是否检测到标签
-    int id;                        // 标签ID
-    float x, y;                    // 标签中心坐标
+    int id;                        // 标签ID（配置着陆板布局时为本帧选用的标签）
+    float x, y;                    // 标签中心坐标（配置着陆板布局时为换算后的着陆板中心）
     int width, height;             // 图像宽高
     double err_x, err_y;           // 与图像中心的偏差
     double norm_err_x, norm_err_y; // 归一化偏差
     float size;                    // 标签大小
+    bool reused = false;           // 画面未变化，复用了上一帧的检测结果（未重新运行检测器）
+    bool tracked = false;          // 由光流跟踪上一帧角点得到（未运行检测器）
+    float confidence = 0.0f;       // 测量置信度：完整检测为1，光流跟踪按前后向误差逐帧衰减
+
+    // 米制位置（需要相机内参和标签尺寸，已按飞行器姿态补偿；pose_valid 为 false 时以下字段无效）
+    bool pose_valid = false; // 是否有米制位置
+    double err_x_m = 0.0;    // 与 err_x 同向的米制偏差（水平坐标系下着陆板的前向偏移）
+    double err_y_m = 0.0;    // 与 err_y 同向的米制偏差（水平坐标系下着陆板的右向偏移取反）
+    double north_m = 0.0;    // 着陆板相对飞行器的北向偏移(m)
+    double east_m = 0.0;     // 着陆板相对飞行器的东向偏移(m)
+    double height_m = 0.0;   // 相对着陆板的高度(m)
+    double m_per_px = 0.0;   // 着陆板处每像素对应的米数（用于把像素预测量换算为米）
+
+    // 时间戳（steady_clock 纳秒）。process() 返回的预测结果沿用最后一次检测的时间戳，可据此判断数据新旧
+    uint64_t sequence = 0;       // 对应的相机帧序号
+    int64_t capture_ns = 0;      // 图像采集时刻
+    int64_t sim_ns = 0;          // 仿真时间戳
+    int64_t detect_start_ns = 0; // 检测开始时刻
+    int64_t detect_end_ns = 0;   // 检测结束时刻
+};
+
+// 区域跟踪参数：在上一次检测位置附近的窗口内搜索，连续丢失后回到全图搜索
+struct RoiTrackingParams
+{
+    bool enabled = true;        // 是否启用区域跟踪
+    int max_misses = 5;         // 窗口内连续丢失多少帧后回到全图搜索
+    float size_factor = 1.5f;   // 窗口半宽相对标签边长的倍数
+    float velocity_gain = 2.0f; // 窗口半宽按帧间速度增加的倍数
+    int min_margin = 32;        // 窗口半宽的最小额外余量(像素)
+    int min_window = 64;        // 窗口最小边长(像素)
+};
+
+// 金字塔检测参数：在降采样图上找候选四边形，只在候选区域内以全分辨率解码并做亚像素角点细化
+struct PyramidParams
+{
+    bool enabled = false;         // 是否启用金字塔检测
+    float scale = 0.0f;           // 粗检测降采样倍数（0表示取当前档位的 quad_decimate，至少为2）
+    int min_quad_side = 6;        // 粗检测图上候选四边形的最小边长(像素)
+    int max_candidates = 8;       // 候选区域过多时退回整幅检测
+    float max_area_ratio = 0.5f;  // 候选区域总面积超过搜索区域的该比例时退回整幅检测
+    float margin_ratio = 0.25f;   // 候选区域外扩比例（相对候选框边长）
+    bool subpixel = true;         // 是否做亚像素角点细化
+};
+
+// 米制位姿估计参数
+struct TagPoseParams
+{
+    bool enabled = true;         // 是否估计米制位姿
+    float tag_size_m = 0.0f;     // 单标签模式（未配置着陆板布局）下的标签边长(m)，0表示不估计
+    double hfov_rad = 1.047;     // 没有标定内参时按水平视场角估算内参（Gazebo 相机默认 60°）
+    CameraIntrinsics intrinsics; // 手动指定的内参（fx 为0时按视场角和图像尺寸估算；加载了相机标定时使用标定内参）
 };
 
+// 级联检测参数：搜索阶段先在降采样图上找高对比度的方形候选区域，只在候选区域内运行解码器
+struct CascadeParams
+{
+    bool enabled = false;        // 是否启用级联检测
+    float scale = 2.0f;          // 候选检测降采样倍数（过大会丢失高空小标签）
+    int min_quad_side = 6;       // 降采样图上候选方块的最小边长(像素)
+    float min_contrast = 20.0f;  // 候选方块内灰度标准差下限（标签黑白相间，均匀色块被排除）
+    int max_regions = 6;         // 候选区域过多时退回整幅检测
+    float max_area_ratio = 0.5f; // 候选区域总面积超过搜索区域的该比例时退回整幅检测
+    float margin_ratio = 0.25f;  // 候选区域外扩比例（相对候选框边长）
+    int audit_interval = 15;     // 每连续拒绝多少帧做一次整幅检测，统计第一级的漏检（0表示不抽检）
+};
+
+// 光流跟踪参数：两次完整检测之间用金字塔 LK 光流跟踪上一帧所选标签的四个角点和中心，不运行检测器
+struct FlowTrackingParams
+{
+    bool enabled = false;         // 是否启用光流跟踪
+    int detect_interval = 5;      // 每隔多少帧做一次完整检测（其余帧光流跟踪）
+    int win_size = 21;            // LK 窗口边长(像素)
+    int max_level = 3;            // 金字塔层数
+    float max_fb_error_px = 1.0f; // 前后向跟踪误差上限(像素)，任一点超过即判为跟踪失败
+    float min_confidence = 0.5f;  // 置信度低于该值时提前做完整检测
+    float max_area_change = 0.3f; // 相邻帧标签面积的相对变化上限（超过说明角点漂移到了别的纹理上）
+};
+
+// 级联检测统计
+struct CascadeStats
+{
+    uint64_t frames = 0;        // 经过第一级的帧数
+    uint64_t rejected = 0;      // 第一级没有候选、跳过解码器的帧数
+    uint64_t fallbacks = 0;     // 候选过多、退回整幅检测的帧数
+    uint64_t regions = 0;       // 送入解码器的候选区域数
+    uint64_t region_hits = 0;   // 解码出标签的候选区域数
+    uint64_t region_misses = 0; // 未解码出标签的候选区域数（第一级误检）
+    uint64_t audits = 0;        // 对拒绝帧的抽检次数
+    uint64_t audit_misses = 0;  // 抽检中发现标签的次数（第一级漏检）
+};
+
+// 标签状态滤波参数（像素坐标，匀速模型）
+struct TagFilterParams
+{
+    float accel_noise_px = 100.0f;      // 标签在图像中的加速度噪声(像素/s^2)
+    float measurement_noise_px = 3.0f;  // 标签中心测量噪声(像素)
+    float initial_velocity_px = 200.0f; // 初始化时速度的标准差(像素/s)
+    float max_coast_s = 1.0f;           // 丢失后最多外推的时间(s)，超过后视为丢失
+};
+
+// 标签状态估计（任意时刻的预测值）
+struct TagEstimate
+{
+    bool valid = false;    // 是否有效
+    int id = 0;            // 标签ID（着陆板模式下为 LandingPad::PAD_ID）
+    float x = 0.0f;        // 标签中心 x(像素)
+    float y = 0.0f;        // 标签中心 y(像素)
+    float vx = 0.0f;       // 速度 x(像素/s)
+    float vy = 0.0f;       // 速度 y(像素/s)
+    double cov[4][4] = {}; // 状态 [x, y, vx, vy] 的协方差
+    double age_s = 0.0;    // 距最后一次检测的时间(s)
+};
+
+#ifdef SIMULATION
 // 获取最新帧函数（仿真模式专用）
-cv::Mat get_latest_frame();
+CameraFrame get_latest_frame();
+#endif
 
 class AprilTagTracker
 {
@@ -33,21 +158,136 @@ public:
     ~AprilTagTracker(); // 清理资源，停止处理线程，销毁AprilTag检测器
 
     void GazeboStart(int argc, char *argv[]); // 在单独线程中启动AprilTag处理循环
-    AprilTagData process();                   // 持续从仿真环境获取图像并检测AprilTag
+    AprilTagData process();                   // 获取当前时刻的标签结果（由最新检测经卡尔曼预测外推，不阻塞）
+    void stop();                              // 停止检测线程
 
     AprilTagData detect(cv::Mat &frame, bool drawOverlay = true);
+    AprilTagData detect(const CameraFrame &frame, bool drawOverlay = false); // 直接使用相机帧中的灰度图检测，仅在叠加显示时生成彩色图
+
+    void setRoiTracking(const RoiTrackingParams &params); // 设置区域跟踪参数
+    void resetTrack();                                    // 重置区域跟踪，下一帧全图搜索
+
+    void setRelativeAltitude(float altitude_m); // 更新当前相对高度（用于选择检测器档位）
+    DetectorProfile activeProfile() const;      // 当前生效的检测器档位
+
+    void setDetectorProfiles(const std::vector<DetectorProfile> &profiles); // 替换检测器档位表
+    void setPyramidMode(const PyramidParams &params);                      // 设置金字塔检测参数
+    void setTileMode(const TileParams &params);                            // 设置分块并行检测参数
+    void setChangeGate(const ChangeGateParams &params);                    // 设置帧变化门控参数
+    uint64_t reusedFrames() const;                                         // 因画面未变化而复用结果的帧数
+    void setPadLayout(const std::vector<PadTag> &tags);                    // 设置着陆板布局（空表示单标签模式）
+    bool loadPadLayout(const std::string &path);                           // 从文件加载着陆板布局
+    void setCascade(const CascadeParams &params);                          // 设置级联检测参数（同时清零统计）
+    void setTagPose(const TagPoseParams &params);                          // 设置米制位姿估计参数（须在检测线程启动前设置）
+    void setAttitude(const VehicleAttitude &attitude);                     // 更新飞行器姿态（用于位姿的倾斜补偿）
+    bool loadCalibration(const std::string &path);                         // 加载相机标定（须在检测线程启动前调用）
+    CascadeStats cascadeStats() const;                                     // 级联检测统计（可在其他线程调用）
+    void setFlowTracking(const FlowTrackingParams &params);                // 设置光流跟踪参数（须在检测线程启动前设置）
+    uint64_t trackedFrames() const;                                        // 由光流跟踪得到结果的帧数
+    void setDeadline(const DeadlineParams &params);                        // 设置检测线程的帧时间预算（须在检测线程启动前设置）
+    DeadlineStats deadlineStats() const;                                   // 帧时间预算统计（可在其他线程调用）
+
+    bool predictTag(int64_t t_ns, TagEstimate &estimate) const; // 预测 t_ns 时刻（steady_clock 纳秒）的标签状态
+    void setTagFilter(const TagFilterParams &params);           // 设置标签状态滤波参数（重置滤波器）
+    const std::vector<TagDetection> &lastDetections() const;               // 最近一帧通过验证的标签
 
 private:
     cv::Mat preprocessImage(const cv::Mat &frame) const;            // 对输入图像进行增强和降噪处理，提高AprilTag检测成功率
     double calculateTagArea(const apriltag_detection_t *det) const; // 计算标签面积（凸四边形面积公式）
     AprilTagData processFrame(const cv::Mat &frame) const;          // 检测图像中的AprilTag，返回检测结果并绘制可视化结果
 
+    std::vector<TagDetection> runDetector(const cv::Mat &gray, const cv::Rect &roi); // 在指定区域内运行检测器
+    std::vector<TagDetection> runPyramid(const cv::Mat &gray, const cv::Rect &roi);  // 粗检测找候选区域，全分辨率解码
+    void estimatePose(AprilTagData &result, const TagDetection &det, const cv::Size &frame_size); // 估计所选标签对应的着陆板米制位置
+    std::vector<TagDetection> runCascade(const cv::Mat &gray, const cv::Rect &roi);  // 级联检测：第一级候选区域 + 区域内解码
+    bool trackFlow(const cv::Mat &gray, std::vector<TagDetection> &detections, float &confidence); // 光流跟踪上一帧所选标签
+    std::vector<cv::Rect> findQuadCandidates(const cv::Mat &coarse, float scale, int min_side,
+                                             float margin_ratio, float min_contrast) const; // 在降采样图上查找候选四边形（返回全分辨率坐标）
+    void refineCorners(const cv::Mat &gray, std::vector<TagDetection> &detections) const; // 亚像素角点细化
+    cv::Rect searchWindow(const cv::Size &frame_size) const;                         // 计算本帧搜索区域
+    void updateTrack(bool found, const cv::Point2f &center, float area);             // 更新区域跟踪状态
+    void applyProfile(const DetectorProfile &profile);                               // 在帧间切换检测器参数（不重建检测器）
+    bool canViewDirectly(const cv::Mat &region) const;                               // 能否直接在Mat数据上构造检测图像视图
+    image_u8_t prepareDetectionBuffer(int width, int height);                        // 获取常驻检测缓冲区
+    void visionLoop();                                                               // 检测线程：取最新帧、检测、发布结果
+
 private:
-    clock_t _start;                 // 用于计时
     std::vector<float> _areas;      // 保存检测到的标签面积
     std::atomic<bool> running_;     // 运行状态标志
     mutable std::mutex data_mutex_; // 数据互斥锁
-    AprilTagData _last_results;     // 最新检测数据
+    AprilTagData _last_results;     // 最近一次检测到标签的结果（短时丢失时返回）
+    AprilTagData _latest_output;    // 检测线程最新输出（受 data_mutex_ 保护）
+    std::thread vision_thread_;     // 检测线程
+
+    // 标签状态滤波（检测线程融合，控制线程查询）
+    TagFilterParams _filter_params;                                  // 滤波参数
+    Filter::ConstantVelocityKalman2D _tag_filter{100.0, 3.0, 200.0}; // 标签中心匀速卡尔曼滤波器
+    int _filter_id = -1;                                             // 滤波器当前跟踪的标签ID
+    mutable std::mutex filter_mutex_;                                // 保护滤波器
+
+    std::vector<TagDetection> _frame_detections; // 最近一帧通过几何验证的标签
+
+    // 区域跟踪状态
+    RoiTrackingParams _roi_params;  // 区域跟踪参数
+    bool _track_valid = false;      // 是否有可用于限定搜索窗口的上一次检测
+    int _track_misses = 0;          // 窗口内连续丢失帧数
+    cv::Point2f _track_center;      // 上一次检测到的标签中心
+    cv::Point2f _track_velocity;    // 标签中心帧间速度(像素/帧)
+    float _track_size = 0.0f;       // 上一次检测到的标签边长(像素)
+
+    PyramidParams _pyramid_params;           // 金字塔检测参数
+    std::unique_ptr<TiledTagDetector> _tiled; // 分块并行检测器（未启用时为空）
+
+    LandingPad _pad;                  // 着陆板布局与逐帧标签选择
+    CameraCalibration _calibration;   // 相机标定：只对所选标签的角点和中心去畸变
+
+    // 米制位姿
+    TagPoseParams _pose_params;
+    VehicleAttitude _attitude;          // 最新的飞行器姿态（控制线程写入）
+    mutable std::mutex attitude_mutex_; // 保护 _attitude
+
+    // 级联检测
+    CascadeParams _cascade_params;
+    int _cascade_rejected_run = 0; // 连续被第一级拒绝的帧数（用于抽检）
+    struct
+    {
+        std::atomic<uint64_t> frames{0}, rejected{0}, fallbacks{0}, regions{0};
+        std::atomic<uint64_t> region_hits{0}, region_misses{0}, audits{0}, audit_misses{0};
+    } _cascade_counters;
+
+    // 帧变化门控：画面未变化时复用上一帧的检测结果
+    ChangeGate _change_gate;
+    AprilTagData _frame_result{};              // 上一次完整检测的结果（无论是否检测到）
+    bool _frame_result_valid = false;          // _frame_result 是否可复用
+    std::atomic<uint64_t> _reused_frames{0};   // 复用的帧数（供其他线程读取）
+
+    // 光流跟踪：两次完整检测之间跟踪上一帧所选标签的角点
+    FlowTrackingParams _flow_params;
+    bool _flow_valid = false;                 // 是否有可跟踪的参考角点
+    TagDetection _flow_tag;                   // 参考帧上所选标签（原始图像坐标）
+    cv::Mat _flow_prev;                       // 参考帧灰度图（常驻复用）
+    float _flow_confidence = 0.0f;            // 参考角点的置信度
+    int _flow_run = 0;                        // 自上次完整检测以来连续跟踪的帧数
+    std::vector<cv::Mat> _flow_prev_pyramid;  // 参考帧局部金字塔（常驻复用）
+    std::vector<cv::Mat> _flow_next_pyramid;  // 本帧局部金字塔（常驻复用）
+    std::atomic<uint64_t> _tracked_frames{0}; // 光流跟踪的帧数（供其他线程读取）
+
+    DeadlineGovernor _governor; // 帧时间预算：跳过过旧的帧，持续超预算时提高降采样倍数
+
+    // 检测器档位调度
+    DetectorProfileScheduler _profile_scheduler; // 档位调度器
+    DetectorProfile _active_profile;             // 当前生效的档位
+    mutable std::mutex profile_mutex_;           // 保护 _active_profile
+    std::atomic<float> _relative_altitude;       // 当前相对高度（未知时为NaN，保持当前档位）
+
+    // 常驻检测缓冲区（跨帧复用，避免每帧分配整帧内存）
+    struct AlignedFree
+    {
+        void operator()(uint8_t *p) const { std::free(p); }
+    };
+    static constexpr size_t DETECTION_ALIGNMENT = 64;   // 检测缓冲区地址及行步长对齐字节数
+    std::unique_ptr<uint8_t, AlignedFree> _det_storage; // 缓冲区内存
+    size_t _det_capacity = 0;                           // 缓冲区容量(字节)
 
     // AprilTag检测器相关
     apriltag_detector_t *td; // AprilTag检测器
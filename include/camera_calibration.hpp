@@ -0,0 +1,87 @@
+#ifndef CAMERA_CALIBRATION_HPP
+#define CAMERA_CALIBRATION_HPP
+
+#include "tag_detection.hpp"
+#include "tag_pose.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+/**
+ * @brief 相机标定与镜头去畸变
+ *
+ * 加载 OpenCV 标定结果（内参矩阵和畸变系数），按帧尺寸预先计算逐像素的去畸变查找表：
+ * 表中每个像素存放其去畸变后的坐标（针孔模型，内参不变）。检测时只对标签的四个角点和中心查表（双线性插值），
+ * 每帧代价只有几次内存访问，而对整帧 cv::remap 在帧率下代价太高；整帧重映射只作为调试用途保留。
+ *
+ * 标定分辨率与帧尺寸不同时按比例缩放内参（要求宽高比一致，即同一传感器区域的缩放）。
+ */
+class CameraCalibration
+{
+public:
+    /**
+     * @brief 从文件加载标定结果
+     * @param path YAML/XML/JSON 文件路径（OpenCV calibration 示例的输出格式）：
+     *   image_width: 640
+     *   image_height: 480
+     *   camera_matrix: !!opencv-matrix { rows: 3, cols: 3, dt: d, data: [...] }
+     *   distortion_coefficients: !!opencv-matrix { rows: 1, cols: 5, dt: d, data: [...] }
+     * @return 加载成功返回true（失败时保持原标定）
+     */
+    bool load(const std::string &path);
+
+    /**
+     * @brief 直接设置标定结果
+     * @param camera_matrix 内参矩阵
+     * @param dist_coeffs 畸变系数（4、5、8、12或14个，可为空表示无畸变）
+     * @param image_size 标定时的图像尺寸
+     * @return 参数有效返回true
+     */
+    bool set(const cv::Matx33d &camera_matrix, const cv::Mat &dist_coeffs, const cv::Size &image_size);
+
+    bool loaded() const { return calib_size_.area() > 0; } // 是否已有标定结果
+
+    /**
+     * @brief 为指定帧尺寸准备查找表（尺寸与上次相同时直接返回）
+     * @param frame_size 帧尺寸
+     * @return 查找表可用返回true
+     */
+    bool prepare(const cv::Size &frame_size);
+
+    bool ready() const { return !lut_.empty(); }                         // 查找表是否可用
+    const CameraIntrinsics &intrinsics() const { return intrinsics_; } // 当前帧尺寸下的内参（去畸变后的坐标使用该内参，由 prepare 写入）
+
+    /**
+     * @brief 按标定结果换算指定帧尺寸下的内参
+     * @param frame_size 帧尺寸
+     * @return 内参副本（未加载标定时无效）
+     *
+     * 只读取 load/set 写入的标定结果，不访问 prepare 生成的查找表。
+     */
+    CameraIntrinsics intrinsicsFor(const cv::Size &frame_size) const;
+
+    cv::Point2f undistortPoint(const cv::Point2f &point) const; // 单点去畸变（查找表未准备时原样返回）
+    TagDetection undistort(const TagDetection &det) const;      // 对检测结果的角点和中心去畸变，返回副本
+
+    /**
+     * @brief 整帧去畸变（仅用于调试显示和标定检查，每帧代价远高于只处理角点）
+     * @param src 原始帧（尺寸须与 prepare 一致）
+     * @param dst 去畸变后的帧
+     * @return 成功返回true
+     */
+    bool remap(const cv::Mat &src, cv::Mat &dst);
+
+private:
+    cv::Matx33d camera_matrix_;   // 标定分辨率下的内参矩阵
+    cv::Mat dist_coeffs_;         // 畸变系数
+    cv::Size calib_size_;         // 标定时的图像尺寸
+
+    cv::Size frame_size_;         // 查找表对应的帧尺寸
+    cv::Matx33d frame_matrix_;    // 帧尺寸下的内参矩阵
+    CameraIntrinsics intrinsics_; // 帧尺寸下的内参
+    cv::Mat lut_;                 // 去畸变查找表（CV_32FC2，帧尺寸）
+    cv::Mat remap_map1_;          // 整帧重映射表（调试用，首次使用时生成）
+    cv::Mat remap_map2_;
+};
+
+#endif // CAMERA_CALIBRATION_HPP
@@ -0,0 +1,42 @@
+#ifndef CAMERA_FRAME_HPP
+#define CAMERA_FRAME_HPP
+
+#include <cstdint>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+// 原始彩色数据的像素格式
+enum class FramePixelFormat
+{
+    NONE, // 无彩色数据（单通道相机）
+    RGB8, // RGB 三通道
+    BGR8  // BGR 三通道
+};
+
+/**
+ * @brief 相机帧
+ *
+ * gray 为检测使用的灰度图（来自帧池或直接引用原始单通道数据），
+ * color 为原始彩色数据的零拷贝视图，仅在需要叠加显示或录像时才通过 bgr() 转换。
+ * 复制 CameraFrame 只增加引用计数，不复制像素数据。
+ */
+struct CameraFrame
+{
+    cv::Mat gray;                                           // 灰度图
+    cv::Mat color;                                          // 原始彩色图视图（可能为空）
+    FramePixelFormat color_format = FramePixelFormat::NONE; // 彩色图像素格式
+    std::shared_ptr<const void> gray_holder;                // 保持灰度缓冲区存活
+    std::shared_ptr<const void> color_holder;               // 保持彩色缓冲区存活
+    uint64_t sequence = 0;                                  // 帧序号
+    int64_t capture_ns = 0;                                 // 采集时刻（steady_clock 纳秒，回调收到图像时；0表示未知）
+    int64_t sim_ns = 0;                                     // 仿真时间戳（ImageStamped::time，纳秒；真机为0）
+
+    bool empty() const { return gray.empty() && color.empty(); }
+    int width() const { return gray.empty() ? color.cols : gray.cols; }
+    int height() const { return gray.empty() ? color.rows : gray.rows; }
+
+    cv::Mat bgr() const;           // 按需生成 BGR 彩色图（每次调用都会转换，热路径中不要使用）
+    cv::Mat grayOrConvert() const; // 返回灰度图，若无灰度图则由彩色图转换
+};
+
+#endif // CAMERA_FRAME_HPP
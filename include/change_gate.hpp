@@ -0,0 +1,55 @@
+#ifndef CHANGE_GATE_HPP
+#define CHANGE_GATE_HPP
+
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+// 帧变化门控参数
+struct ChangeGateParams
+{
+    bool enabled = true;           // 是否启用变化门控
+    int block_px = 16;             // 缩略图每格对应的原图边长(像素)
+    float mean_threshold = 1.5f;   // 缩略图平均绝对差阈值（灰度级），低于该值视为画面未变化
+    float block_threshold = 10.0f; // 单格绝对差阈值（灰度级），任一格超过即视为变化（捕捉小目标的局部移动）
+    int max_reuse_frames = 10;     // 连续复用的最大帧数，超过后强制重新检测
+};
+
+/**
+ * @brief 帧变化门控
+ *
+ * 把灰度图按 block_px 面积平均降采样为缩略图（640x480 对应 40x30），与最近一次完整检测时的参考缩略图比较绝对差（SAD）。
+ * 画面整体和局部都没有明显变化时，可直接复用上一次的检测结果；否则更新参考缩略图，由调用方重新检测。
+ * 参考图只在完整检测时更新，缓慢漂移会持续累积直到超过阈值，不会被逐帧“吞掉”。
+ */
+class ChangeGate
+{
+public:
+    void setParams(const ChangeGateParams &params); // 设置参数（同时清除参考图）
+    const ChangeGateParams &params() const { return params_; }
+
+    /**
+     * @brief 判断本帧能否复用上一次的检测结果
+     * @param gray 本帧灰度图
+     * @return true 表示画面未变化、可复用；false 表示需要重新检测（参考图已更新为本帧）
+     */
+    bool unchanged(const cv::Mat &gray);
+
+    void reset(); // 清除参考图（下一帧必定重新检测）
+
+    // 统计
+    uint64_t checkedFrames() const { return checked_; }
+    uint64_t reusedFrames() const { return reused_; }
+    float lastMeanDiff() const { return last_mean_diff_; } // 最近一次比较的平均绝对差
+
+private:
+    ChangeGateParams params_;
+    cv::Mat reference_;          // 参考缩略图（最近一次完整检测的帧）
+    cv::Mat thumb_;              // 本帧缩略图（常驻复用）
+    cv::Mat diff_;               // 差值图（常驻复用）
+    int reuse_count_ = 0;        // 连续复用的帧数
+    uint64_t checked_ = 0;       // 参与判断的帧数
+    uint64_t reused_ = 0;        // 复用的帧数
+    float last_mean_diff_ = 0.0f;
+};
+
+#endif // CHANGE_GATE_HPP
@@ -0,0 +1,63 @@
+#ifndef COLOR_CONVERT_HPP
+#define COLOR_CONVERT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief 相机→检测器路径上的彩色转灰度内核
+ *
+ * 三通道转灰度采用 BT.601 系数的 14 位定点计算：
+ *   gray = (c0 * k0 + c1 * k1 + c2 * k2 + 8192) >> 14
+ * 其中 RGB 顺序 k = (4899, 9617, 1868)，BGR 顺序系数对调。
+ * 各指令集版本（AVX2 / SSE4.1 / NEON）与标量参考实现逐位一致，运行时按CPU能力选择，
+ * 首次使用时会在合成图像上与标量实现比对，不一致则退回标量实现；完整的逐位比对见 tests/color_convert_test.cpp。
+ */
+namespace ColorConvert
+{
+    // 三通道数据的通道顺序
+    enum class ChannelOrder
+    {
+        RGB,
+        BGR
+    };
+
+    // 内核指令集
+    enum class Isa
+    {
+        SCALAR,
+        SSE41,
+        AVX2,
+        NEON
+    };
+
+    Isa activeIsa();              // 当前使用的指令集
+    const char *isaName(Isa isa); // 指令集名称
+    bool isaAvailable(Isa isa);   // 本平台已编译该指令集的内核且CPU支持
+    bool setIsa(Isa isa);         // 强制使用指定指令集（CPU不支持或与参考实现不一致时返回false，用于基准测试和校验）
+
+    // 整幅三通道图像转灰度
+    void toGray(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                int width, int height, ChannelOrder order);
+
+    // 三通道图像转灰度并 2x2 降采样（输出尺寸为 width/2 x height/2，2x2 均值四舍五入）
+    void toGrayHalf(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                    int width, int height, ChannelOrder order);
+
+    // 标量参考实现（用于校验与基准对比）
+    namespace Reference
+    {
+        void toGray(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                    int width, int height, ChannelOrder order);
+        void toGrayHalf(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                        int width, int height, ChannelOrder order);
+    } // namespace Reference
+
+    // cv::Mat 封装：dst 尺寸和类型已匹配时直接写入（不重新分配，可写入帧池缓冲区）
+    void toGray(const cv::Mat &src, cv::Mat &dst, ChannelOrder order);
+    void toGrayHalf(const cv::Mat &src, cv::Mat &dst, ChannelOrder order);
+    void toGrayRoi(const cv::Mat &src, const cv::Rect &roi, cv::Mat &dst, ChannelOrder order); // 只转换 roi 区域，dst 尺寸为 roi 尺寸
+} // namespace ColorConvert
+
+#endif // COLOR_CONVERT_HPP
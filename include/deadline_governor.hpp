@@ -0,0 +1,105 @@
+#ifndef DEADLINE_GOVERNOR_HPP
+#define DEADLINE_GOVERNOR_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// 帧时间预算参数
+struct DeadlineParams
+{
+    bool enabled = true;        // 是否启用时间预算调节
+    float budget_ms = 0.0f;     // 单帧检测时间预算(ms)，0表示按实测帧周期的 budget_ratio 倍
+    float budget_ratio = 0.9f;  // 自动预算相对帧周期的比例
+    float max_age_ms = 0.0f;    // 取到的帧已等待超过该时长时跳过(ms)，0表示按两个帧周期
+    int escalate_after = 3;     // 连续超预算多少帧后提高降采样等级
+    int recover_after = 30;     // 连续多少帧满足恢复条件后降低降采样等级
+    float recover_ratio = 0.8f; // 降一级后的预计耗时低于该比例的预算才恢复（避免在两个等级间来回切换）
+    int max_level = 2;          // 最高降采样等级
+    float level_scale = 1.5f;   // 每提高一级，检测器降采样倍数乘以该系数
+};
+
+// 帧时间预算统计
+struct DeadlineStats
+{
+    uint64_t frames = 0;        // 发布结果的帧数（含未完整检测的帧）
+    uint64_t light_frames = 0;  // 未完整检测（画面复用或光流跟踪）的帧数
+    uint64_t skipped = 0;       // 因过旧被跳过的帧数
+    uint64_t overruns = 0;      // 检测耗时超出预算的帧数
+    int level = 0;              // 当前降采样等级
+    float effective_fps = 0.0f; // 最近一秒发布结果的帧率
+    float budget_ms = 0.0f;     // 当前预算(ms)
+    float detect_ms = 0.0f;     // 完整检测耗时的滑动平均(ms)
+    float period_ms = 0.0f;     // 实测帧周期(ms)
+};
+
+/**
+ * @brief 检测线程的帧时间预算调节器
+ *
+ * 相机帧经最新帧信箱送到检测线程，检测慢于帧周期时旧帧会被新帧覆盖，不会积压；
+ * 但检测耗时本身超过帧周期时，每个结果的延迟和发布间隔都会变长。调节器按帧序号和采集时刻估计帧周期，
+ * 统计每帧检测耗时：连续超出预算时逐级提高检测器降采样倍数，耗时持续有余量时逐级恢复；
+ * 取到的帧已经过旧（检测线程被阻塞等）时直接跳过，等待下一帧，使控制循环拿到的测量延迟有界。
+ *
+ * admit/complete/completeLight/level 只在检测线程调用，stats 可在其他线程调用。
+ */
+class DeadlineGovernor
+{
+public:
+    void setParams(const DeadlineParams &params); // 设置参数（同时清除状态和统计）
+    const DeadlineParams &params() const { return params_; }
+
+    /**
+     * @brief 判断取到的帧是否值得检测
+     * @param sequence 帧序号
+     * @param capture_ns 采集时刻（steady_clock 纳秒，0表示未知）
+     * @param now_ns 当前时刻
+     * @return false 表示帧已过旧、应跳过
+     */
+    bool admit(uint64_t sequence, int64_t capture_ns, int64_t now_ns);
+
+    /**
+     * @brief 记录一帧完整检测完成（耗时参与降采样等级调节）
+     * @param start_ns 检测开始时刻
+     * @param end_ns 检测结束时刻
+     */
+    void complete(int64_t start_ns, int64_t end_ns);
+
+    /**
+     * @brief 记录一帧未完整检测的结果（画面复用或光流跟踪），只计入帧率，不参与等级调节
+     * @param end_ns 结果发布时刻
+     */
+    void completeLight(int64_t end_ns);
+
+    int level() const { return level_; } // 当前降采样等级
+    float decimateScale() const;         // 当前等级对应的降采样倍数系数（等级0为1）
+
+    DeadlineStats stats() const; // 统计（可在其他线程调用）
+
+private:
+    float budgetMs() const;        // 当前预算(ms)，帧周期未知时返回0
+    void countFrame(int64_t end_ns); // 计入帧数和帧率
+
+    DeadlineParams params_;
+    int level_ = 0;               // 降采样等级
+    int over_run_ = 0;            // 连续超预算帧数
+    int under_run_ = 0;           // 连续有余量帧数
+    uint64_t last_sequence_ = 0;  // 上一次取到的帧序号
+    int64_t last_capture_ns_ = 0; // 上一次取到的帧的采集时刻
+    float period_ms_ = 0.0f;      // 帧周期滑动平均(ms)
+    float detect_ms_ = 0.0f;      // 检测耗时滑动平均(ms)
+    int64_t window_start_ns_ = 0; // 帧率统计窗口起点
+    uint64_t window_frames_ = 0;  // 统计窗口内完成的帧数
+
+    // 供其他线程读取的统计
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> light_frames_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<int> level_snapshot_{0};
+    std::atomic<float> effective_fps_{0.0f};
+    std::atomic<float> budget_snapshot_{0.0f};
+    std::atomic<float> detect_snapshot_{0.0f};
+    std::atomic<float> period_snapshot_{0.0f};
+};
+
+#endif // DEADLINE_GOVERNOR_HPP
@@ -0,0 +1,43 @@
+#ifndef DETECTOR_PROFILE_HPP
+#define DETECTOR_PROFILE_HPP
+
+#include <string>
+#include <vector>
+
+// 检测器参数档位
+struct DetectorProfile
+{
+    std::string name;    // 档位名称（用于遥测显示）
+    float min_altitude;  // 适用的最低相对高度(m)
+    float quad_decimate; // 四边形检测降采样倍数
+    float quad_sigma;    // 高斯模糊标准差
+    int nthreads;        // 检测器线程数
+};
+
+/**
+ * @brief 检测器档位调度器
+ *
+ * 根据当前相对高度和上一次检测到的标签像素面积选择检测器参数：
+ * 低空时标签占满画面，可用大降采样倍数换取速度；高空时标签很小，需要全分辨率。
+ * 高度切换带迟滞，标签在当前降采样下过小时自动退回更精细的档位，避免丢失目标。
+ */
+class DetectorProfileScheduler
+{
+public:
+    DetectorProfileScheduler();
+
+    void setProfiles(const std::vector<DetectorProfile> &profiles); // 设置档位表（按 min_altitude 升序）
+    void setHysteresis(float hysteresis_m);                          // 设置高度切换迟滞(m)
+    void setMinTagSidePx(float min_side_px);                         // 设置降采样后标签的最小边长(像素)
+
+    const DetectorProfile &select(float altitude_m, float tag_area_px); // 根据高度和标签面积选择档位（tag_area_px <= 0 表示未检测到标签）
+    const DetectorProfile &current() const;                             // 当前档位
+
+private:
+    std::vector<DetectorProfile> profiles_; // 档位表
+    size_t current_index_ = 0;              // 当前档位索引
+    float hysteresis_m_ = 0.3f;             // 高度切换迟滞
+    float min_tag_side_px_ = 24.0f;         // 降采样后标签最小边长
+};
+
+#endif // DETECTOR_PROFILE_HPP
@@ -0,0 +1,74 @@
+#ifndef EVENT_FLAGS_HPP
+#define EVENT_FLAGS_HPP
+
+#include "singleton.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// 控制线程关心的事件（按位组合）
+enum ControlEvent : uint32_t
+{
+    EVENT_DETECTION = 1u << 0, // 检测线程发布了新的检测结果
+    EVENT_TELEMETRY = 1u << 1, // 遥测位置/姿态更新
+    EVENT_COMMAND = 1u << 2,   // 收到 MQTT 任务命令
+    EVENT_ALL = EVENT_DETECTION | EVENT_TELEMETRY | EVENT_COMMAND,
+};
+
+// 事件统计（累计值）
+struct EventStats
+{
+    uint64_t posted = 0;    // post 调用次数
+    uint64_t wakeups = 0;   // 等待者被事件唤醒的次数
+    uint64_t coalesced = 0; // 被合并的 post 次数（置位时该位已挂起，没有产生新的唤醒）
+};
+
+/**
+ * @brief 可合并的事件标志
+ *
+ * 生产者（检测线程、遥测回调、MQTT 回调）用 post 置位并唤醒等待者，单个消费者（控制线程）用 waitUntil 等待、
+ * 用 take 取出并清除。同一位在被取走前多次置位只算一次，突发事件合并为一次唤醒；没有事件时等待者一直休眠到截止时刻。
+ * 同时记录每一位首次挂起的时刻，用于统计事件到处理的延迟。
+ */
+class EventFlags
+{
+public:
+    void post(uint32_t bits); // 置位并唤醒等待者（可在任意线程调用）
+
+    /**
+     * @brief 取出并清除挂起的事件
+     * @param mask 要取出的事件位
+     * @param since_ns 输出取出的事件中最早挂起的时刻(steady_clock 纳秒)，没有事件时不修改，可为空
+     * @return 取出的事件位
+     */
+    uint32_t take(uint32_t mask, int64_t *since_ns = nullptr);
+
+    uint32_t pending() const { return pending_.load(std::memory_order_acquire); } // 当前挂起的事件位
+
+    /**
+     * @brief 等待到有事件挂起或到达截止时刻
+     * @param deadline_ns 绝对截止时刻(steady_clock 纳秒，与 CLOCK_MONOTONIC 同源)
+     * @return 有事件挂起返回true
+     */
+    bool waitUntil(int64_t deadline_ns);
+
+    EventStats stats() const; // 事件统计
+
+private:
+    static constexpr int BITS = 32;
+
+    std::atomic<uint32_t> pending_{0};
+    std::atomic<int64_t> since_ns_[BITS] = {}; // 各位首次挂起的时刻（0 表示未挂起）
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    std::atomic<uint64_t> posted_{0};
+    std::atomic<uint64_t> wakeups_{0};
+    std::atomic<uint64_t> coalesced_{0};
+};
+
+typedef MeyersSingleton<EventFlags> control_events; // 首次调用可能来自多个线程，使用线程安全的局部静态初始化
+
+#endif // EVENT_FLAGS_HPP
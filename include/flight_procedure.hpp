@@ -1,12 +1,13 @@
 #ifndef FLIGHT_PROCEDURE_HPP
 #define FLIGHT_PROCEDURE_HPP
 
+#include "action_executor.hpp"
 #include "mavsdk_members.hpp"
 
 int offboard_flight_position(Mavsdk_members &mavsdk, float north_m, float east_m, float down_m, float yaw_deg);
 int offboard_flight_body_velocity(Mavsdk_members &mavsdk, float forward_m_s, float right_m_s, float down_m_s, float yaw_rate_deg_s);
 
-int arming_and_takeoff(Mavsdk_members &mavsdk, float takeoff_altitude_m);
-int land_and_disarm(Mavsdk_members &mavsdk);
+std::shared_future<ActionOutcome> arming_and_takeoff(Mavsdk_members &mavsdk, float takeoff_altitude_m, ActionCallback done = nullptr); // 非阻塞，结果通过 future/回调报告
+std::shared_future<ActionOutcome> land_and_disarm(Mavsdk_members &mavsdk, ActionCallback done = nullptr);                          // 非阻塞，着地后自动上锁
 
 #endif // FLIGHT_PROCEDURE_HPP
\ No newline at end of file
@@ -7,8 +7,9 @@
 #include <mavsdk/plugins/action/action.h>
 #include <mavsdk/plugins/mission/mission.h>
 #include <string>
+#include <vector>
 
-int fly_mission(Mavsdk_members &mavsdk, const std::string &plan_file); // 综合函数：根据文件或自定义创建航点，上传并执行任务
+std::vector<mavsdk::Mission::MissionItem> load_mission_items(const std::string &plan_file); // 根据文件或自定义创建航点（文件为空时使用自定义航点）
 
 std::string determine_mission_file_path(const std::string &mission_type,
                                         const std::string &base_path = "/home/senen/桌面/receive/",
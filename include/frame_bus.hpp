@@ -0,0 +1,115 @@
+#ifndef FRAME_BUS_HPP
+#define FRAME_BUS_HPP
+
+#include "camera_frame.hpp"
+#include "latest_mailbox.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef std::shared_ptr<const CameraFrame> FramePtr; // 共享的只读帧（所有订阅者持有同一份，不复制像素）
+
+// 订阅队列满时的丢弃策略
+enum class DropPolicy
+{
+    DROP_OLDEST, // 丢弃最旧的帧，保留最新帧（检测、显示：只关心最新画面）
+    DROP_NEWEST  // 丢弃新到的帧，保留已排队的帧（编码等需要连续帧的消费者，由消费者追赶）
+};
+
+// 订阅者统计
+struct SubscriberStats
+{
+    std::string name;       // 订阅者名称
+    size_t depth = 0;       // 队列深度
+    uint64_t delivered = 0; // 入队的帧数
+    uint64_t dropped = 0;   // 因队列满被丢弃的帧数
+    uint64_t taken = 0;     // 被取走的帧数
+};
+
+/**
+ * @brief 帧总线上的一个订阅（每个消费者一个独立队列）
+ *
+ * 深度为1且丢弃旧帧的订阅（检测、显示）由无锁三缓冲信箱承载，发布只是一次原子交换，不触碰任何锁；
+ * 其他订阅按给定深度和丢弃策略缓存在环形队列中，发布者只在入队时短暂持有本订阅的锁。
+ * 两种方式下发布者都从不等待消费者，各订阅者互不影响，某个消费者变慢只会丢它自己的帧。
+ * 每个订阅只能有一个消费者线程。
+ */
+class FrameSubscription
+{
+public:
+    FrameSubscription(const std::string &name, size_t depth, DropPolicy policy);
+    FrameSubscription(const FrameSubscription &) = delete;
+    FrameSubscription &operator=(const FrameSubscription &) = delete;
+
+    bool tryTake(FramePtr &out);                                         // 取出队首的帧（不阻塞），队列为空时返回false
+    bool waitTake(FramePtr &out, std::chrono::milliseconds timeout);     // 等待并取出队首的帧，超时或订阅关闭时返回false
+    void close();                                                        // 关闭订阅并唤醒等待者（清空队列，释放帧引用）
+    bool closed() const { return closed_.load(); }
+
+    const std::string &name() const { return name_; }
+    SubscriberStats stats() const;
+
+private:
+    friend class FrameBus;
+    void push(const FramePtr &frame); // 入队（发布线程调用）
+    bool takeFromRing(FramePtr &out); // 取出环形队列队首的帧（调用者持有 mutex_）
+
+    const std::string name_;
+    const size_t depth_;
+    const DropPolicy policy_;
+    std::unique_ptr<LatestMailbox<FramePtr>> mailbox_; // 深度为1且丢弃旧帧时使用的无锁信箱（否则为空）
+
+    std::vector<FramePtr> ring_; // 环形队列（容量即队列深度，订阅时一次分配；使用信箱时为空）
+    size_t head_ = 0;            // 队首下标
+    size_t count_ = 0;           // 队列中的帧数
+    int waiters_ = 0;            // 正在阻塞等待的消费者数量（受 mutex_ 保护）
+    mutable std::mutex mutex_;   // 保护环形队列
+    std::condition_variable cond_;
+    std::atomic<bool> closed_{false};
+
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> taken_{0};
+};
+
+/**
+ * @brief 帧广播总线
+ *
+ * 采集线程每帧构造一次只读的 CameraFrame 并发布其 shared_ptr，每个订阅者（检测、显示、编码等）都拿到同一份帧的引用，
+ * 最后一个持有者释放时帧池缓冲区才回收。订阅者列表按写时复制保存，发布时只做一次原子读取，
+ * 增减订阅者不会阻塞发布，新增消费者也不会抢走其他消费者的帧。
+ */
+class FrameBus
+{
+public:
+    /**
+     * @brief 订阅帧
+     * @param name 订阅者名称（用于统计）
+     * @param depth 队列深度（至少为1）
+     * @param policy 队列满时的丢弃策略
+     * @return 订阅句柄
+     */
+    std::shared_ptr<FrameSubscription> subscribe(const std::string &name, size_t depth, DropPolicy policy);
+
+    void unsubscribe(const std::shared_ptr<FrameSubscription> &subscription); // 取消订阅（同时关闭该订阅）
+    void publish(FramePtr frame);                                             // 发布一帧（不阻塞）
+    void close();                                                             // 关闭所有订阅（唤醒全部等待者）
+
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); } // 发布总数
+    std::vector<SubscriberStats> stats() const;                                          // 各订阅者统计
+
+private:
+    typedef std::vector<std::shared_ptr<FrameSubscription>> SubscriberList;
+
+    std::shared_ptr<const SubscriberList> subscribers_ = std::make_shared<const SubscriberList>(); // 订阅者列表（写时复制，原子读写）
+    std::mutex modify_mutex_;                                                                      // 串行化订阅/取消订阅
+    std::atomic<uint64_t> published_{0};
+};
+
+#endif // FRAME_BUS_HPP
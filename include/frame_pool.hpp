@@ -0,0 +1,45 @@
+#ifndef FRAME_POOL_HPP
+#define FRAME_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// 帧池分配出的图像：mat 为指向池内存的视图，holder 释放时缓冲区自动归还帧池
+struct PooledImage
+{
+    cv::Mat mat;                  // 图像视图（不拥有内存）
+    std::shared_ptr<void> holder; // 缓冲区持有者（引用计数归零时归还帧池）
+};
+
+/**
+ * @brief 图像帧缓冲池
+ *
+ * 预先分配并循环复用固定尺寸的图像缓冲区，避免每帧 new/delete 整帧内存。
+ * 行步长按 64 字节对齐，便于 SIMD 访问以及直接构造 AprilTag 图像视图。
+ * 缓冲区通过引用计数管理，最后一个使用者释放后自动回到空闲链表。
+ */
+class FramePool
+{
+public:
+    explicit FramePool(size_t max_free_buffers = 4);
+
+    PooledImage acquire(int rows, int cols, int type); // 获取一块指定尺寸和类型的图像缓冲区
+
+    uint64_t allocations() const; // 实际分配内存的次数
+    uint64_t reuses() const;      // 复用空闲缓冲区的次数
+
+    static constexpr size_t ROW_ALIGNMENT = 64; // 行步长对齐字节数
+
+private:
+    struct Block; // 单块缓冲区
+    struct State; // 帧池共享状态（被所有未归还的缓冲区共同持有）
+
+    std::shared_ptr<State> state_;
+};
+
+#endif // FRAME_POOL_HPP
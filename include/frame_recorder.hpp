@@ -0,0 +1,222 @@
+#ifndef FRAME_RECORDER_HPP
+#define FRAME_RECORDER_HPP
+
+#include "camera_frame.hpp"
+#include "singleton.hpp"
+#include "spsc_ring.hpp"
+#include "tag_detection.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * 录像文件格式（小端，所有记录按 64 字节对齐）：
+ *
+ *   <会话目录>/seg_000000.rec, seg_000001.rec, ...
+ *
+ *   每个分段文件 = RecordSegmentHeader + 若干条记录
+ *   每条记录     = RecordHeader + 载荷
+ *     FRAME     : 灰度像素，height 行、每行 stride 字节
+ *     DETECTION : count 个 RecordedTag
+ *
+ * 分段文件在写入前预分配并整体映射，写线程每写完一条记录才更新 used_bytes，
+ * 异常断电时文件内容在 used_bytes 之前总是完整的。帧记录与检测记录分别按时间顺序写入，
+ * 两者之间通过 sequence（相机帧序号）关联。
+ */
+
+// 记录类型
+enum class RecordType : uint32_t
+{
+    FRAME = 1,    // 灰度帧
+    DETECTION = 2 // 一帧的检测结果
+};
+
+// 分段文件头
+struct RecordSegmentHeader
+{
+    char magic[8];          // "PX4REC\0\0"
+    uint32_t version;       // 格式版本
+    uint32_t header_size;   // 文件头大小（即第一条记录的偏移）
+    uint64_t segment_index; // 分段序号
+    uint64_t capacity;      // 文件预分配大小(字节)
+    uint64_t used_bytes;    // 已写入的有效字节数（含文件头）
+    uint64_t record_count;  // 已写入的记录数
+    uint8_t reserved[16];   // 保留
+};
+
+// 记录头
+struct RecordHeader
+{
+    uint32_t type;         // RecordType
+    uint32_t payload_size; // 载荷字节数
+    uint64_t sequence;     // 相机帧序号
+    int64_t time_ns;       // 时间戳（steady_clock，纳秒；FRAME为采集时刻，DETECTION为检测完成时刻）
+    int64_t sim_ns;        // 仿真时间戳（纳秒，真机为0）
+    uint32_t width;        // 帧宽（FRAME）
+    uint32_t height;       // 帧高（FRAME）
+    uint32_t stride;       // 行步长（FRAME）
+    uint32_t count;        // 标签数（DETECTION）
+    uint8_t reserved[16];  // 保留
+};
+
+// 录像中的单个标签
+struct RecordedTag
+{
+    int32_t id;
+    int32_t hamming;
+    float decision_margin;
+    float center[2];
+    float corners[8]; // 四个角点 x0,y0,...,x3,y3（与 TagDetection::corners 顺序一致）
+};
+
+static_assert(sizeof(RecordSegmentHeader) == 64, "RecordSegmentHeader 必须为64字节");
+static_assert(sizeof(RecordHeader) == 64, "RecordHeader 必须为64字节（载荷按64字节对齐）");
+
+// 录像配置
+struct RecorderConfig
+{
+    std::string directory;            // 录像根目录（每次 start 在其下创建以时间命名的会话目录）
+    size_t segment_bytes = 64u << 20; // 单个分段文件大小
+    size_t max_segments = 0;          // 最多保留的分段数，超出时删除最旧的分段（0表示不限）
+};
+
+/**
+ * @brief 分段内存映射录像器
+ *
+ * 相机回调线程通过 recordFrame 提交帧（只复制帧的引用，不复制像素），检测线程通过 recordDetections 提交结果，
+ * 两者各自写入一个单生产者单消费者无锁队列，队列满时直接丢弃并计数，调用方从不阻塞。
+ * 后台写线程负责把像素和检测结果复制到预分配、已映射的分段文件中，并提前准备好下一个分段，
+ * 换段时不在写路径上创建文件。
+ */
+class FrameRecorder
+{
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    bool start(const RecorderConfig &config); // 开始录像（创建会话目录并启动写线程）
+    void stop();                              // 停止录像（写完队列中剩余记录后关闭文件）
+    bool recording() const;                   // 是否正在录像
+
+    bool recordFrame(const CameraFrame &frame);                                                            // 提交一帧（采集线程调用，时间戳取自帧）
+    bool recordDetections(uint64_t sequence, int64_t time_ns, const std::vector<TagDetection> &detections); // 提交一帧的检测结果（检测线程调用）
+
+    std::string sessionDirectory() const; // 当前会话目录
+
+    // 统计
+    uint64_t framesWritten() const { return frames_written_; }
+    uint64_t framesDropped() const { return frames_dropped_; }
+    uint64_t detectionsWritten() const { return detections_written_; }
+    uint64_t detectionsDropped() const { return detections_dropped_; }
+    uint64_t bytesWritten() const { return bytes_written_; }
+
+    static constexpr size_t RECORD_ALIGNMENT = 64;      // 记录对齐字节数
+    static constexpr size_t MAX_TAGS_PER_RECORD = 16;   // 单帧最多记录的标签数
+    static constexpr size_t FRAME_QUEUE_DEPTH = 8;      // 帧队列深度
+    static constexpr size_t DETECTION_QUEUE_DEPTH = 64; // 检测结果队列深度
+
+private:
+    // 待写入的检测结果（定长，入队时不分配内存）
+    struct DetectionEntry
+    {
+        uint64_t sequence = 0;
+        int64_t time_ns = 0;
+        uint32_t count = 0;
+        RecordedTag tags[MAX_TAGS_PER_RECORD];
+    };
+
+    // 已映射的分段文件
+    struct Segment
+    {
+        int fd = -1;
+        uint8_t *base = nullptr;
+        size_t capacity = 0;
+        uint64_t index = 0;
+        std::string path;
+
+        RecordSegmentHeader *header() const { return reinterpret_cast<RecordSegmentHeader *>(base); }
+        bool valid() const { return base != nullptr; }
+    };
+
+    void writerLoop();                                                  // 写线程主循环
+    void writeFrame(const CameraFrame &frame);                          // 写入帧记录
+    void writeDetections(const DetectionEntry &entry);                  // 写入检测记录
+    uint8_t *reserveRecord(size_t payload_size, RecordHeader *&header); // 在当前分段中预留一条记录的空间，不足时换段
+    void commitRecord(size_t record_size);                              // 提交记录（更新文件头中的有效长度）
+    bool openSegment(uint64_t index, Segment &segment);                 // 创建并映射分段文件
+    void closeSegment(Segment &segment, bool keep);                     // 截断到有效长度并关闭分段（keep为false时删除文件）
+    bool rotateSegment();                                               // 切换到预先准备好的下一个分段
+
+    RecorderConfig config_;
+    std::string session_dir_;
+    std::atomic<bool> recording_{false};
+    std::thread writer_thread_;
+
+    SpscRing<CameraFrame> frame_queue_;        // 采集线程 → 写线程（只持有帧引用）
+    SpscRing<DetectionEntry> detection_queue_; // 检测线程 → 写线程
+
+    Segment current_;                   // 正在写入的分段
+    Segment spare_;                     // 预先准备好的下一个分段
+    std::vector<std::string> finished_; // 已写完的分段（用于按 max_segments 删除最旧的分段）
+
+    std::atomic<uint64_t> frames_written_{0};
+    std::atomic<uint64_t> frames_dropped_{0};
+    std::atomic<uint64_t> detections_written_{0};
+    std::atomic<uint64_t> detections_dropped_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+};
+
+// 录像中的一条记录（像素和标签数据直接指向映射内存，不复制）
+struct RecordView
+{
+    RecordType type = RecordType::FRAME;
+    const RecordHeader *header = nullptr;
+    cv::Mat gray;                      // FRAME：灰度图视图
+    const RecordedTag *tags = nullptr; // DETECTION：标签数组
+    size_t tag_count = 0;              // DETECTION：标签数
+};
+
+/**
+ * @brief 录像读取器
+ *
+ * 以只读方式映射会话目录下的全部分段文件，按文件顺序遍历记录。
+ * 返回的图像和标签指针直接指向映射内存，在读取器销毁前有效。
+ */
+class FrameRecordReader
+{
+public:
+    FrameRecordReader() = default;
+    ~FrameRecordReader();
+
+    FrameRecordReader(const FrameRecordReader &) = delete;
+    FrameRecordReader &operator=(const FrameRecordReader &) = delete;
+
+    bool open(const std::string &session_dir); // 打开会话目录
+    void close();                              // 解除全部映射
+    bool next(RecordView &view);               // 读取下一条记录，读完返回false
+    void rewind();                             // 回到第一条记录
+
+    size_t segmentCount() const { return segments_.size(); }
+
+    static bool isRecording(const std::string &path); // 判断目录是否为录像会话目录
+
+private:
+    struct MappedSegment
+    {
+        const uint8_t *base = nullptr;
+        size_t size = 0;   // 映射大小
+        size_t used = 0;   // 有效字节数
+        size_t offset = 0; // 当前读取位置
+    };
+
+    std::vector<MappedSegment> segments_;
+    size_t current_ = 0;
+};
+
+typedef MeyersSingleton<FrameRecorder> frame_recorder; // 首次调用可能来自采集、检测或控制线程，使用线程安全的局部静态初始化
+
+#endif // FRAME_RECORDER_HPP
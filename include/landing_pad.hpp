@@ -0,0 +1,87 @@
+#ifndef LANDING_PAD_HPP
+#define LANDING_PAD_HPP
+
+#include "tag_detection.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// 着陆板上的一个标签
+struct PadTag
+{
+    int id = 0;              // 标签ID
+    float size_m = 0.0f;     // 标签黑色边框外沿边长(m)，即检测角点围成的正方形边长
+    float offset_x_m = 0.0f; // 标签中心相对着陆板中心的偏移(m)，沿标签 x 轴（角点 p0→p1 方向）
+    float offset_y_m = 0.0f; // 标签中心相对着陆板中心的偏移(m)，沿标签 y 轴（角点 p3→p0 方向）
+};
+
+// 标签选择参数
+struct PadSelectParams
+{
+    float min_side_px = 16.0f;   // 标签边长下限(像素)，更小时角点误差大
+    float max_side_ratio = 0.7f; // 标签边长上限（相对图像短边），更大时容易出画
+    float edge_margin_px = 4.0f; // 角点距图像边缘的最小距离(像素)，贴边的标签可能被截断
+    float switch_ratio = 1.25f;  // 新标签评分超过当前标签的该倍数才切换，避免在两个标签间来回跳
+};
+
+// 本帧的着陆板估计
+struct PadEstimate
+{
+    bool valid = false;    // 是否有效
+    int index = -1;        // 所选标签在检测结果中的下标
+    int id = 0;            // 所选标签ID
+    cv::Point2f center;    // 着陆板中心(像素)
+    float side_px = 0.0f;  // 所选标签平均边长(像素)
+    float px_per_m = 0.0f; // 所选标签处的像素/米（未配置布局时为0）
+    float score = 0.0f;    // 评分
+};
+
+/**
+ * @brief 多尺度嵌套着陆板
+ *
+ * 着陆板上布置多个不同尺寸的标签：大标签供高空识别，小标签在接近地面、大标签出画后接管。
+ * 每帧在检测到的着陆板标签中选出条件最好的一个（边长适中、完整在画面内、离板中心近），
+ * 按其尺寸和偏移把标签中心换算为着陆板中心，输出单一的板中心估计。
+ * 标签朝向由角点给出，偏移按标签平面内的仿射近似换算（相机近似垂直向下时误差很小）。
+ *
+ * 未配置标签时退化为单标签模式：每个检测到的标签都视为板中心，选边长合适的最大者。
+ */
+class LandingPad
+{
+public:
+    static constexpr int PAD_ID = -2; // 着陆板模式下状态滤波器使用的ID（不同标签换算到同一个板中心，切换标签时不重置滤波器）
+
+    void setTags(const std::vector<PadTag> &tags);      // 设置着陆板布局
+    const std::vector<PadTag> &tags() const { return tags_; }
+    bool empty() const { return tags_.empty(); }         // 是否未配置布局
+    const PadTag *find(int id) const;                    // 查找标签，不属于着陆板时返回 nullptr
+    void setSelectParams(const PadSelectParams &params); // 设置标签选择参数
+    bool load(const std::string &path);                  // 从 YAML/JSON 文件加载布局（cv::FileStorage 格式）
+
+    /**
+     * @brief 在本帧检测结果中选择条件最好的标签并估计着陆板中心
+     * @param detections 本帧通过几何验证的检测结果
+     * @param frame_size 图像尺寸
+     * @return 着陆板估计（没有着陆板标签时无效）
+     */
+    PadEstimate select(const std::vector<TagDetection> &detections, const cv::Size &frame_size);
+
+    /**
+     * @brief 由单个标签的角点换算着陆板中心
+     * @param det 检测结果（可以是去畸变后的角点）
+     * @return 着陆板中心（标签不属于着陆板或未配置布局时为标签中心）
+     */
+    cv::Point2f center(const TagDetection &det) const;
+
+    void reset(); // 清除上一次选择（下一帧不做切换迟滞）
+
+private:
+    float score(const TagDetection &det, const PadTag &tag, const cv::Size &frame_size, float &side_px) const; // 标签评分
+
+    std::vector<PadTag> tags_;
+    PadSelectParams params_;
+    int last_id_ = -1; // 上一帧选择的标签
+};
+
+#endif // LANDING_PAD_HPP
@@ -29,6 +29,9 @@ public:
 
     int StartStateMachine();
     void updateState(Mavsdk_members &mavsdk);
+    void abort();                                                                 // 终止降落流程（保持当前设定点悬停，由后续命令接管）
+    bool isRunning() const { return start_landing_flag_; }                        // 降落流程是否在执行
+    std::shared_future<ActionOutcome> landFuture() const { return land_future_; } // 最近一次交给自动降落的结果（未交接时无效）
 
     void setRelevantData(AprilTagData &landmark,
                          PIDOutput &pid_output_,
@@ -65,10 +68,19 @@ private:
     std::chrono::time_point<std::chrono::system_clock> waiting_state_time_;
     std::chrono::time_point<std::chrono::system_clock> landmark_loss_start_time_;
 
-    double ANGULAR_VELOCITY = 0.5; // 绕圈搜索时的角速度，单位：rad/s
-    double RADIUS = 0.5;           // 绕圈搜索的半径，单位：米
+    double ANGULAR_VELOCITY = 0.5;      // 绕圈搜索时的角速度，单位：rad/s
+    double RADIUS = 0.5;                // 绕圈搜索的半径，单位：米
+    double POSITION_TOLERANCE_M = 0.15; // 地标带米制位置时的水平位置容忍度（与高度无关），单位：米
+    double DETECTION_RATIO = 0.6;       // 等待状态内检测到地标的周期占比达到该值才认为稳定（与控制频率无关）
 
     int landmark_detection_count_ = 0; // 地标检测计数
+    int landmark_check_count_ = 0;     // 等待状态内的检查次数
+
+    bool circle_first_entry_ = true;                                        // 是否首次进入绕圈搜索状态
+    std::chrono::time_point<std::chrono::system_clock> circle_start_time_;  // 绕圈搜索开始时间
+    bool landing_timer_started_ = false;                                    // 降落状态计时是否已开始
+    std::chrono::time_point<std::chrono::system_clock> landing_start_time_; // 降落状态开始时间
+    std::shared_future<ActionOutcome> land_future_;                         // 自动降落（降落并上锁）的结果
 };
 
 typedef NormalSingleton<LandingStateMachine> landing_state_machine;
@@ -0,0 +1,186 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include "singleton.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// 当前 steady_clock 时刻(纳秒)，整条视觉链路的时间戳都使用这一时钟
+inline int64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 延迟统计快照(微秒)
+struct LatencySummary
+{
+    uint64_t count = 0; // 样本数
+    double p50_us = 0;  // 中位数
+    double p95_us = 0;  // 95分位
+    double p99_us = 0;  // 99分位
+    double max_us = 0;  // 最大值
+};
+
+/**
+ * @brief 无锁延迟直方图
+ *
+ * 以微秒为单位按对数分桶（每个2倍区间分4档，相对误差约12%），覆盖 0 ~ 16 秒。
+ * record 只做一次原子加，可在任意线程调用；snapshot 读取时允许与 record 并发（结果为近似值）。
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKETS = 4;                            // 每个2倍区间的分档数
+    static constexpr int MAX_EXPONENT = 24;                          // 最大 2^24 微秒
+    static constexpr int BUCKETS = SUB_BUCKETS * (MAX_EXPONENT - 1); // 桶数
+
+    // 记录一个样本(纳秒)，负值视为0
+    void record(int64_t latency_ns)
+    {
+        const uint64_t us = latency_ns > 0 ? static_cast<uint64_t>(latency_ns) / 1000 : 0;
+        buckets_[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t prev = max_us_.load(std::memory_order_relaxed);
+        while (us > prev && !max_us_.compare_exchange_weak(prev, us, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // 读取统计结果，reset为true时同时清零（用于按周期统计）
+    LatencySummary snapshot(bool reset = false)
+    {
+        std::array<uint64_t, BUCKETS> counts;
+        uint64_t total = 0;
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            counts[i] = reset ? buckets_[i].exchange(0, std::memory_order_relaxed) : buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        LatencySummary summary;
+        summary.count = total;
+        summary.max_us = static_cast<double>(reset ? max_us_.exchange(0, std::memory_order_relaxed) : max_us_.load(std::memory_order_relaxed));
+        if (total == 0)
+        {
+            return summary;
+        }
+        summary.p50_us = percentile(counts, total, 0.50);
+        summary.p95_us = percentile(counts, total, 0.95);
+        summary.p99_us = percentile(counts, total, 0.99);
+        return summary;
+    }
+
+private:
+    // 桶序号：小于 SUB_BUCKETS 的值各占一桶，其余按最高位所在区间及其后两位分档
+    static int bucketIndex(uint64_t us)
+    {
+        if (us < SUB_BUCKETS)
+        {
+            return static_cast<int>(us);
+        }
+        const int msb = 63 - __builtin_clzll(us);
+        if (msb >= MAX_EXPONENT)
+        {
+            return BUCKETS - 1;
+        }
+        const int sub = static_cast<int>((us >> (msb - 2)) & (SUB_BUCKETS - 1));
+        return SUB_BUCKETS + (msb - 2) * SUB_BUCKETS + sub;
+    }
+
+    // 桶的代表值（区间中点）
+    static double bucketValue(int index)
+    {
+        if (index < SUB_BUCKETS)
+        {
+            return index;
+        }
+        const int msb = (index - SUB_BUCKETS) / SUB_BUCKETS + 2;
+        const int sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        const double width = static_cast<double>(1ull << (msb - 2));
+        return (SUB_BUCKETS + sub) * width + width * 0.5;
+    }
+
+    static double percentile(const std::array<uint64_t, BUCKETS> &counts, uint64_t total, double q)
+    {
+        const uint64_t rank = static_cast<uint64_t>(q * (total - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                return bucketValue(i);
+            }
+        }
+        return bucketValue(BUCKETS - 1);
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{}; // 各桶计数
+    std::atomic<uint64_t> max_us_{0};                       // 最大值
+};
+
+/**
+ * @brief 视觉链路各阶段延迟
+ *
+ *   采集(capture) → 检测开始 → 检测结束 → 控制器使用
+ *      queue          detect       handoff
+ *   └──────────────────── total ────────────────────┘
+ */
+class PipelineLatency
+{
+public:
+    LatencyHistogram queue;   // 采集 → 检测开始（在信箱中等待的时间）
+    LatencyHistogram detect;  // 检测开始 → 检测结束
+    LatencyHistogram handoff; // 检测结束 → 控制器使用
+    LatencyHistogram total;   // 采集 → 控制器使用（控制器实际作用时误差的“年龄”）
+
+    // 记录一帧检测（无采集时间戳的帧只记录检测耗时）
+    void recordDetection(int64_t capture_ns, int64_t start_ns, int64_t end_ns)
+    {
+        if (capture_ns > 0)
+        {
+            queue.record(start_ns - capture_ns);
+        }
+        detect.record(end_ns - start_ns);
+    }
+
+    // 记录控制器使用一次新的检测结果
+    void recordConsumption(int64_t capture_ns, int64_t end_ns, int64_t consume_ns)
+    {
+        handoff.record(consume_ns - end_ns);
+        if (capture_ns > 0)
+        {
+            total.record(consume_ns - capture_ns);
+        }
+    }
+
+    // 生成本周期统计文本并清零（毫秒）
+    std::string report()
+    {
+        std::string text = "Latency(ms p50/p95/p99/max):";
+        text += format(" queue ", queue.snapshot(true));
+        text += format(" detect ", detect.snapshot(true));
+        text += format(" handoff ", handoff.snapshot(true));
+        text += format(" total ", total.snapshot(true));
+        return text;
+    }
+
+private:
+    static std::string format(const char *name, const LatencySummary &s)
+    {
+        char buf[96];
+        std::snprintf(buf, sizeof(buf), "%s%.1f/%.1f/%.1f/%.1f(n=%llu)", name,
+                      s.p50_us / 1000.0, s.p95_us / 1000.0, s.p99_us / 1000.0, s.max_us / 1000.0,
+                      static_cast<unsigned long long>(s.count));
+        return buf;
+    }
+};
+
+typedef MeyersSingleton<PipelineLatency> pipeline_latency; // 首次调用可能来自采集、检测或控制线程，使用线程安全的局部静态初始化
+
+#endif // LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,131 @@
+#ifndef LATEST_MAILBOX_HPP
+#define LATEST_MAILBOX_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief 单生产者/单消费者的"最新值"信箱（无锁三缓冲）
+ *
+ * 生产者写入后台槽位后通过一次原子交换发布，永远不会等待消费者；
+ * 消费者每次取出的都是最新发布的值，未被取走就被覆盖的旧值计入丢弃计数。
+ * 仅当消费者正在阻塞等待时，生产者才会短暂加锁以唤醒它。
+ *
+ * @tparam T 信箱中传递的数据类型（需可默认构造、可移动）
+ */
+template <typename T>
+class LatestMailbox
+{
+public:
+    LatestMailbox() = default;
+    LatestMailbox(const LatestMailbox &) = delete;
+    LatestMailbox &operator=(const LatestMailbox &) = delete;
+
+    /**
+     * @brief 发布新值（生产者线程调用，不阻塞）
+     * @param value 要发布的值
+     */
+    void publish(T value)
+    {
+        slots_[back_] = std::move(value);
+
+        // 将写好的槽位与中间槽位交换，并标记为新数据
+        const uint8_t prev = middle_.exchange(static_cast<uint8_t>(back_ | FRESH_BIT));
+        if (prev & FRESH_BIT)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed); // 上一个值未被取走即被覆盖
+        }
+        back_ = prev & INDEX_MASK;
+        published_.fetch_add(1, std::memory_order_relaxed);
+
+        if (waiters_.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_cond_.notify_one();
+        }
+    }
+
+    /**
+     * @brief 尝试取出最新值（消费者线程调用，不阻塞）
+     * @param out 输出最新值
+     * @return 有尚未取出的新值时返回true
+     */
+    bool tryTake(T &out)
+    {
+        if (!(middle_.load() & FRESH_BIT))
+        {
+            return false;
+        }
+
+        // 只有消费者会清除新数据标志，因此此处交换得到的一定是新数据
+        const uint8_t prev = middle_.exchange(front_);
+        front_ = prev & INDEX_MASK;
+        out = std::move(slots_[front_]);
+        taken_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief 等待并取出最新值（消费者线程调用）
+     * @param out 输出最新值
+     * @param timeout 最长等待时间
+     * @return 超时或信箱关闭时返回false
+     */
+    template <typename Rep, typename Period>
+    bool waitTake(T &out, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        if (tryTake(out))
+        {
+            return true;
+        }
+
+        waiters_.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            wait_cond_.wait_for(lock, timeout, [this]
+                                { return closed_.load() || (middle_.load() & FRESH_BIT); });
+        }
+        waiters_.fetch_sub(1);
+
+        return !closed_.load() && tryTake(out);
+    }
+
+    /**
+     * @brief 关闭信箱并唤醒所有等待者
+     */
+    void close()
+    {
+        closed_ = true;
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cond_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(); }
+
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); } // 发布总数
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }     // 未被取走即被覆盖的数量
+    uint64_t taken() const { return taken_.load(std::memory_order_relaxed); }         // 被取走的数量
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3; // 槽位索引掩码
+    static constexpr uint8_t FRESH_BIT = 0x4;  // 新数据标志位
+
+    T slots_[3];                     // 三个数据槽位
+    uint8_t back_ = 0;               // 生产者独占的写入槽位
+    std::atomic<uint8_t> middle_{1}; // 中间交换槽位（含新数据标志）
+    uint8_t front_ = 2;              // 消费者独占的读取槽位
+
+    std::atomic<bool> closed_{false};
+    std::atomic<int> waiters_{0};       // 正在阻塞等待的消费者数量
+    std::mutex wait_mutex_;             // 仅用于阻塞等待
+    std::condition_variable wait_cond_; // 新数据通知
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> taken_{0};
+};
+
+#endif // LATEST_MAILBOX_HPP
@@ -6,6 +6,7 @@
 #include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <iostream>
 #include <vector>
@@ -41,6 +42,40 @@ namespace Filter
         void reset(double initial_value);
     };
 
+    /*::::::::::::::::::::::::::::::::::::::::::::::::::: 二维匀速卡尔曼滤波器 :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
+    // 状态 [x, y, vx, vy]，测量 [x, y]，按测量的时间戳预测，可在任意时刻查询预测值及协方差
+    class ConstantVelocityKalman2D
+    {
+    public:
+        struct State
+        {
+            double x[4];    // 状态 [x, y, vx, vy]
+            double P[4][4]; // 状态协方差
+        };
+
+        ConstantVelocityKalman2D(double accel_noise, double measurement_noise, double initial_velocity_std);
+
+        bool update(double mx, double my, int64_t t_ns); // 融合一次测量，返回false表示新息超出门限、已用该测量重新初始化
+        bool predict(int64_t t_ns, State &out) const;    // 预测 t_ns 时刻的状态（不修改滤波器）
+        void reset();                                    // 重置，下一次测量重新初始化
+
+        bool initialized() const { return initialized_; }
+        int64_t lastUpdateNs() const { return last_update_ns_; }
+        void setGate(double gate) { gate_ = gate; } // 新息马氏距离平方门限（<=0 不检验）
+
+    private:
+        void initialize(double mx, double my, int64_t t_ns);
+        void propagate(State &s, double dt) const; // 匀速模型时间更新
+
+        double q_;               // 加速度噪声谱密度（accel_noise^2）
+        double r_;               // 测量噪声方差
+        double v0_var_;          // 初始速度方差
+        double gate_;            // 新息门限
+        bool initialized_;       // 是否已初始化
+        int64_t last_update_ns_; // 最后一次测量的时刻
+        State state_;            // 最后一次测量后的状态
+    };
+
     /*::::::::::::::::::::::::::::::::::::::::::::::::::::::::: 互补滤波器 :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
     double complementaryFilter(double alpha, double fast, double slow);
 
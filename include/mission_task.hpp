@@ -0,0 +1,119 @@
+#ifndef MISSION_TASK_HPP
+#define MISSION_TASK_HPP
+
+#include "mavsdk_members.hpp"
+#include "singleton.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 步骤状态
+enum class StepStatus
+{
+    RUNNING,   // 执行中
+    SUCCEEDED, // 成功
+    FAILED,    // 失败
+};
+
+/**
+ * @brief 任务步骤（可等待的异步操作）
+ *
+ * start() 发出异步操作后立即返回，之后控制线程每个周期调用 poll() 查询进展，直到成功或失败。
+ * 所有函数都在控制线程中调用，不得阻塞；等待命令应答、等待着地等都通过多次 poll() 完成。
+ */
+class TaskStep
+{
+public:
+    virtual ~TaskStep() = default;
+
+    virtual std::string name() const = 0;                // 步骤名称
+    virtual void start(Mavsdk_members &mavsdk) = 0;      // 开始执行（发出异步操作后立即返回）
+    virtual StepStatus poll(Mavsdk_members &mavsdk) = 0; // 查询进展
+    virtual void cancel(Mavsdk_members &mavsdk)          // 被新任务取消（默认不做处理，由新任务接管飞行器）
+    {
+        (void)mavsdk;
+    }
+
+    const std::string &message() const { return message_; } // 结束说明（失败原因等）
+
+protected:
+    std::string message_;
+};
+
+typedef std::unique_ptr<TaskStep> StepPtr;
+
+/**
+ * @brief 顺序组合步骤
+ *
+ * 依次执行子步骤：前一步成功后在同一个周期内开始下一步（续接），任一步失败即整体失败。
+ * 组合步骤本身也是步骤，可以继续嵌套组合。
+ */
+class SequenceStep : public TaskStep
+{
+public:
+    SequenceStep(std::string name, std::vector<StepPtr> steps);
+
+    std::string name() const override; // 组合名称及当前子步骤，如 "waypoint_landing > mission"
+    void start(Mavsdk_members &mavsdk) override;
+    StepStatus poll(Mavsdk_members &mavsdk) override;
+    void cancel(Mavsdk_members &mavsdk) override; // 取消当前子步骤
+
+private:
+    std::string name_;
+    std::vector<StepPtr> steps_;
+    size_t index_ = 0; // 当前子步骤
+};
+
+StepPtr takeoffStep(float altitude_m);              // 解锁起飞并等待到达起飞高度
+StepPtr missionStep(const std::string &plan_file); // 上传并执行航点任务，等待任务完成（文件为空时使用自定义航点）
+StepPtr visionLandingStep();                        // 视觉识别降落，等待着地上锁
+StepPtr landStep();                                 // 自动降落，等待着地上锁
+
+// 把若干步骤组合成顺序步骤
+template <typename... Steps>
+StepPtr sequence(std::string name, Steps... steps)
+{
+    std::vector<StepPtr> list;
+    (list.push_back(std::move(steps)), ...);
+    return std::make_unique<SequenceStep>(std::move(name), std::move(list));
+}
+
+/**
+ * @brief 协作式任务引擎
+ *
+ * 同一时刻执行一个任务（一个步骤或步骤组合），控制线程每个周期调用 poll() 推进。
+ * 提交新任务时先取消正在执行的任务，因此新的 MQTT 命令总能立即接管，长时间的航点任务也不会阻塞控制线程。
+ */
+class TaskEngine
+{
+public:
+    /**
+     * @brief 提交任务（取消正在执行的任务）
+     * @param mavsdk MAVSDK成员集合
+     * @param name 任务名称
+     * @param task 任务步骤
+     */
+    void submit(Mavsdk_members &mavsdk, const std::string &name, StepPtr task);
+
+    void cancel(Mavsdk_members &mavsdk); // 取消正在执行的任务
+    void poll(Mavsdk_members &mavsdk);   // 推进正在执行的任务（控制线程每周期调用）
+
+    bool busy() const { return task_ != nullptr; }                        // 是否有任务在执行
+    std::string current() const;                                          // 当前任务及步骤名称（空闲时为 "IDLE"）
+    void setReporter(std::function<void(const std::string &)> reporter); // 设置任务开始/完成/失败/取消的报告函数
+
+private:
+    void report(const std::string &text); // 报告任务进展
+
+    StepPtr task_;                                      // 正在执行的任务
+    std::string name_;                                  // 任务名称
+    bool started_ = false;                              // 任务是否已开始
+    std::function<void(const std::string &)> reporter_; // 报告函数
+};
+
+typedef NormalSingleton<TaskEngine> task_engine;
+
+#endif // MISSION_TASK_HPP
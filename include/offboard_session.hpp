@@ -0,0 +1,159 @@
+#ifndef OFFBOARD_SESSION_HPP
+#define OFFBOARD_SESSION_HPP
+
+#include "singleton.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mavsdk/plugins/offboard/offboard.h>
+#include <mavsdk/plugins/telemetry/telemetry.h>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 设定点类型
+enum class SetpointType : uint32_t
+{
+    POSITION_NED = 0,  // NED 位置 + 偏航角：north_m, east_m, down_m, yaw_deg
+    VELOCITY_BODY = 1, // 机体速度 + 偏航角速度：forward_m_s, right_m_s, down_m_s, yawspeed_deg_s
+};
+
+// 设定点
+struct OffboardSetpoint
+{
+    SetpointType type = SetpointType::POSITION_NED;
+    float values[4] = {}; // 含义见 SetpointType
+    int64_t stamp_ns = 0; // 发布时刻(steady_clock 纳秒)
+};
+
+/**
+ * @brief 单写者无锁设定点槽（顺序锁）
+ *
+ * 写者（控制线程）只做几次原子存储，不会阻塞；读者（发送线程）读到写了一半的数据时重读。
+ */
+class SetpointSlot
+{
+public:
+    void write(const OffboardSetpoint &setpoint); // 写入最新设定点（只允许一个写者线程）
+
+    /**
+     * @brief 读取最新设定点
+     * @param setpoint 输出设定点
+     * @return 写入次数（0 表示尚未写入，此时不修改 setpoint）
+     */
+    uint64_t read(OffboardSetpoint &setpoint) const;
+
+private:
+    std::atomic<uint64_t> seq_{0}; // 奇数表示正在写入
+    std::atomic<uint32_t> type_{0};
+    std::atomic<float> values_[4] = {};
+    std::atomic<int64_t> stamp_ns_{0};
+};
+
+// 会话状态
+enum class OffboardState : int
+{
+    IDLE,     // 未接管（没有设定点或已释放）
+    STARTING, // 正在发送设定点并请求进入 offboard 模式
+    ACTIVE,   // 已处于 offboard 模式
+    LOST,     // 处于 offboard 模式期间飞行模式被切走（遥控器接管或飞控失效保护），须 release() 后才能重新接管
+};
+
+// 会话参数
+struct OffboardSessionParams
+{
+    double rate_hz = 20.0;           // 设定点发送频率(Hz)，限制在 20~50
+    double mode_grace_s = 1.0;       // 进入 offboard 后多久开始检查飞行模式(s)，等待遥测中的模式更新
+    double retry_interval_s = 1.0;   // 进入 offboard 失败后的重试间隔(s)
+    double setpoint_timeout_s = 0.5; // 设定点超过该时间未更新时，速度设定点改为悬停(零速度)，避免控制线程卡住时持续按旧速度飞行
+};
+
+// 会话统计（累计值）
+struct OffboardStats
+{
+    OffboardState state = OffboardState::IDLE;
+    uint64_t published = 0;      // 控制线程发布的设定点数
+    uint64_t sent = 0;           // 发送线程发出的设定点数
+    uint64_t stale = 0;          // 因设定点过旧改为悬停发送的次数
+    uint64_t start_attempts = 0; // 请求进入 offboard 的次数
+    uint64_t start_failures = 0; // 其中失败的次数
+    uint64_t mode_losses = 0;    // 模式丢失次数
+};
+
+/**
+ * @brief Offboard 会话
+ *
+ * 控制代码只向无锁槽发布最新设定点；独立的发送线程按固定频率把最新设定点发给飞控，
+ * 首次有设定点时请求进入 offboard 模式（只请求一次，失败按间隔重试），之后持续发送而不再往返确认。
+ * 进入 offboard 后按遥测飞行模式检测模式丢失：丢失后停止发送、进入 LOST 并通过回调报告，
+ * 在 release() 之前不会自动重新接管（不与遥控器争夺控制权）。
+ * 主动切换到其他模式（降落、起飞、航点任务）之前须调用 release()，否则会被判为模式丢失。
+ */
+class OffboardSession
+{
+public:
+    ~OffboardSession();
+
+    /**
+     * @brief 启动发送线程
+     * @param offboard MAVSDK offboard 插件
+     * @param telemetry MAVSDK 遥测插件（用于检测模式丢失）
+     * @param params 会话参数
+     * @return 启动成功返回true（已启动时返回false）
+     */
+    bool start(mavsdk::Offboard &offboard, mavsdk::Telemetry &telemetry, const OffboardSessionParams &params = OffboardSessionParams());
+    void stop();                              // 停止发送线程（不切换飞行模式）
+    bool running() const { return running_; } // 发送线程是否在运行
+
+    /**
+     * @brief 发布 NED 位置设定点
+     * @return 会话可用返回true；模式丢失后返回false（设定点不会发出）
+     */
+    bool publishPosition(float north_m, float east_m, float down_m, float yaw_deg);
+
+    /**
+     * @brief 发布机体速度设定点
+     * @return 会话可用返回true；模式丢失后返回false（设定点不会发出）
+     */
+    bool publishBodyVelocity(float forward_m_s, float right_m_s, float down_m_s, float yawspeed_deg_s);
+
+    void release(); // 结束会话：停止发送并清除模式丢失状态（不等待进行中的进入请求，其结果作废）
+
+    OffboardState state() const { return state_; }            // 当前状态
+    void setModeLossCallback(std::function<void()> callback); // 设置模式丢失回调（在发送线程中调用）
+    OffboardStats stats() const;                              // 会话统计
+    static std::string stateToString(OffboardState state);    // 状态名称
+
+private:
+    bool publish(const OffboardSetpoint &setpoint); // 发布设定点并在空闲时请求接管
+    void streamLoop();                              // 发送线程主循环
+    bool send(const OffboardSetpoint &setpoint);    // 发出一个设定点
+
+    mavsdk::Offboard *offboard_ = nullptr;
+    mavsdk::Telemetry *telemetry_ = nullptr;
+    OffboardSessionParams params_;
+
+    SetpointSlot slot_;                                     // 最新设定点
+    std::atomic<bool> engaged_{false};                      // 是否请求接管（有设定点且未释放、未丢失）
+    std::atomic<OffboardState> state_{OffboardState::IDLE}; // 会话状态
+    std::mutex command_mutex_;                              // 保护会话状态转换与 epoch_（不在持锁时做命令往返）
+    uint64_t epoch_ = 0;                                    // 会话代数，release() 时递增，用于丢弃过期的进入请求结果
+    std::mutex callback_mutex_;                             // 保护模式丢失回调
+    std::function<void()> mode_loss_callback_;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> stale_{0};
+    std::atomic<uint64_t> start_attempts_{0};
+    std::atomic<uint64_t> start_failures_{0};
+    std::atomic<uint64_t> mode_losses_{0};
+};
+
+typedef NormalSingleton<OffboardSession> offboard_session;
+
+#endif // OFFBOARD_SESSION_HPP
@@ -0,0 +1,122 @@
+#ifndef PERIODIC_SCHEDULER_HPP
+#define PERIODIC_SCHEDULER_HPP
+
+#include "event_flags.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 周期任务统计
+struct TaskStats
+{
+    std::string name;          // 任务名称
+    double rate_hz = 0.0;      // 执行频率(Hz)
+    int priority = 0;          // 优先级（数值越大越先执行）
+    uint64_t runs = 0;         // 执行次数
+    uint64_t event_runs = 0;   // 其中由事件触发的次数
+    uint64_t misses = 0;       // 错过的周期数（完成时已过下一次释放时刻，被跳过的释放）
+    uint64_t overruns = 0;     // 单次执行耗时超过周期的次数
+    double avg_exec_ms = 0.0;  // 平均执行耗时(ms)
+    double max_exec_ms = 0.0;  // 最大执行耗时(ms)
+    double max_late_ms = 0.0;  // 最大启动延迟(ms)：实际开始执行时刻相对释放时刻
+    double avg_event_ms = 0.0; // 事件触发的平均延迟(ms)：开始执行时刻相对事件首次挂起时刻
+    double max_event_ms = 0.0; // 事件触发的最大延迟(ms)
+};
+
+/**
+ * @brief 固定频率周期调度器
+ *
+ * 所有任务在调用 run() 的线程中执行。每个任务按自己的频率以绝对时刻释放：
+ * 下一次释放时刻 = 上一次释放时刻 + 周期，用 clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME) 睡到最近的释放时刻，
+ * 任务体的耗时和唤醒误差不会累积成频率漂移。同一时刻有多个任务到期时按优先级从高到低执行。
+ * 任务执行超过一个周期时不补跑错过的释放（避免突发连续执行），只计入错过次数，按原相位继续。
+ *
+ * 设置事件源后任务还可以由事件触发：关注的事件挂起时立即执行（不早于上次执行后的最小间隔），
+ * 周期释放退化为兜底（距上次执行满一个周期仍没有事件时执行）。此时空闲等待改用事件源的条件变量
+ * （同样以 CLOCK_MONOTONIC 绝对时刻为截止），事件到达即唤醒，没有事件时一直休眠到最近的释放时刻。
+ *
+ * 统计中的计数为累计值，耗时和延迟的最大值在每次 report() 后清零（按汇报周期统计）。
+ */
+class PeriodicScheduler
+{
+public:
+    /**
+     * @brief 注册周期任务（须在 run() 之前调用）
+     * @param name 任务名称
+     * @param rate_hz 执行频率(Hz)
+     * @param priority 优先级（数值越大越先执行）
+     * @param task 任务函数
+     * @return 注册成功返回true
+     */
+    bool addTask(const std::string &name, double rate_hz, int priority, std::function<void()> task);
+
+    /**
+     * @brief 注册由事件触发的任务（须在 run() 之前调用）
+     * @param name 任务名称
+     * @param rate_hz 兜底频率(Hz)：距上次执行满一个周期仍没有事件时执行
+     * @param max_rate_hz 事件触发的最高频率(Hz)，限制突发事件下的执行次数
+     * @param priority 优先级（数值越大越先执行）
+     * @param events 关注的事件位（ControlEvent 组合）
+     * @param task 任务函数
+     * @return 注册成功返回true
+     */
+    bool addEventTask(const std::string &name, double rate_hz, double max_rate_hz, int priority, uint32_t events, std::function<void()> task);
+
+    void setEventSource(EventFlags *events); // 设置事件源（须在 run() 之前调用，为空时只按周期执行）
+
+    /**
+     * @brief 在当前线程中运行调度循环，直到 running 变为 false 或调用 stop()
+     * @param running 外部运行标志
+     */
+    void run(const std::atomic<bool> &running);
+    void stop(); // 请求退出调度循环（可在任务内或其他线程调用）
+
+    /**
+     * @brief 把当前线程设为 SCHED_FIFO 实时调度（需要 CAP_SYS_NICE 或 root）
+     * @param priority 实时优先级（1-99）
+     * @return 设置成功返回true，失败时保持普通调度
+     */
+    static bool setRealtimePriority(int priority);
+
+    std::vector<TaskStats> stats() const; // 各任务统计（在调度线程中调用）
+    std::string report();                 // 各任务统计的文本摘要（同时清零最大值）
+
+private:
+    struct Task
+    {
+        std::string name;
+        int64_t period_ns = 0;        // 周期(纳秒)
+        int priority = 0;             // 优先级
+        std::function<void()> fn;     // 任务函数
+        int64_t next_release_ns = 0;  // 下一次释放时刻(CLOCK_MONOTONIC 纳秒)
+        uint32_t events = 0;          // 关注的事件位
+        int64_t min_interval_ns = 0;  // 事件触发的最小间隔
+        uint32_t pending = 0;         // 已取出、尚未处理的事件位
+        int64_t pending_since_ns = 0; // 挂起事件中最早的挂起时刻
+        int64_t last_start_ns = 0;    // 上次开始执行的时刻
+        uint64_t runs = 0;
+        uint64_t event_runs = 0;
+        uint64_t misses = 0;
+        uint64_t overruns = 0;
+        int64_t exec_sum_ns = 0;      // 累计执行耗时
+        int64_t exec_max_ns = 0;      // 本汇报周期内最大执行耗时
+        int64_t late_max_ns = 0;      // 本汇报周期内最大启动延迟
+        int64_t event_sum_ns = 0;     // 累计事件触发延迟
+        int64_t event_max_ns = 0;     // 本汇报周期内最大事件触发延迟
+    };
+
+    bool insertTask(Task task);                   // 按优先级插入任务
+    int64_t eventReadyNs(const Task &task) const; // 有挂起事件的任务最早可执行的时刻（没有挂起事件时为最大值）
+    void collectEvents();                         // 从事件源取出事件，分发到关注它们的任务
+    void runTask(Task &task);                     // 执行一次任务并更新统计和下一次释放时刻
+
+    std::vector<Task> tasks_;      // 按优先级从高到低排序
+    EventFlags *events_ = nullptr; // 事件源
+    uint32_t event_mask_ = 0;      // 所有任务关注的事件位
+    std::atomic<bool> stop_requested_{false};
+};
+
+#endif // PERIODIC_SCHEDULER_HPP
@@ -2,6 +2,7 @@
 #define PID_HPP
 
 #include "apriltag_tracker.hpp"
+#include "latency_histogram.hpp"
 #include "singleton.hpp"
 
 #include <atomic>
@@ -16,6 +17,10 @@ struct PIDOutput
     double x;         // x方向控制输出
     double y;         // y方向控制输出
     double timestamp; // 时间戳(秒)
+
+    int64_t capture_ns = 0; // 本次输出所用检测结果的图像采集时刻(steady_clock 纳秒)
+    int64_t consume_ns = 0; // 控制器使用该检测结果的时刻(steady_clock 纳秒)
+    bool metric = false;    // 本次输出是否按米制偏差计算（否则按像素偏差）
 };
 
 // PID控制器类
@@ -28,14 +33,16 @@ public:
     void getLandmark(const AprilTagData &data); // 获取地标数据
     void PID_update();                          // 计算PID控制指令
     PIDOutput Output_PID() const;               // 输出PID控制结果
+    void setMetricMode(bool enabled);           // 地标带米制位置时是否按米制偏差控制（默认开启）
 
 private:
     // PID参数结构
     struct PIDParameters
     {
-        double kp; // 比例系数
-        double ki; // 积分系数
-        double kd; // 微分系数
+        double kp;             // 比例系数
+        double ki;             // 积分系数
+        double kd;             // 微分系数
+        double integral_limit; // 积分限幅
     };
 
     // 误差状态结构
@@ -49,22 +56,32 @@ private:
     };
 
     // 私有成员变量
-    PIDParameters pid_params_;   // PID控制参数
+    PIDParameters pid_params_;    // PID控制参数（像素偏差）
+    PIDParameters metric_params_; // PID控制参数（米制偏差，与高度无关）
+    bool metric_mode_;           // 是否允许按米制偏差控制
+    bool using_metric_;          // 当前误差状态的单位（切换单位时重置误差状态）
     AprilTagData landmark_;      // 当前地标数据
     AprilTagData last_landmark_; // 上一帧地标数据
     ErrorState error_x_;         // x方向误差状态
     ErrorState error_y_;         // y方向误差状态
     PIDOutput pid_output_;       // PID控制输出
     bool is_first_detection_;    // 是否首次检测到地标
-    int current_step_;           // 渐进控制步数
+    double ramp_elapsed_s_;      // 渐进控制已持续时间(秒)
+    int64_t consumed_detect_ns_; // 上一次使用的检测结果的检测结束时刻（用于识别新结果）
 
     // 获取当前时间(秒)
     double get_current_time() const;
 
 private:
-    void First_Detection();        // 处理首次检测到地标的情况
-    void apply_LowPass_Filter();   // 应用低通滤波器
-    void calculate_PID(double dt); // 计算PID控制量
+    static constexpr double RAMP_TIME_S = 10.0;  // 首次检测后控制量从0渐进到全量的时间(秒)
+    static constexpr double FILTER_TAU_S = 0.45; // 误差低通滤波时间常数(秒)，10Hz 下相当于每周期系数0.2
+    static constexpr double MAX_DT_S = 0.5;      // 单次更新的最大时间步长(秒)，长时间未调用后避免渐进和滤波一步完成
+
+    void First_Detection(double dt);      // 处理首次检测到地标的情况
+    void apply_LowPass_Filter(double dt); // 应用低通滤波器
+    void calculate_PID(double dt);        // 计算PID控制量
+    void consume_Landmark();              // 记录检测结果被控制器使用的时刻和链路延迟
+    void select_Units();                  // 选择误差单位（米制/像素）
 };
 
 typedef NormalSingleton<PID> pid;
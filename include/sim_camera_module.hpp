@@ -1,13 +1,22 @@
 #pragma once
+#include "camera_frame.hpp"
+#include "frame_bus.hpp"
+#include "frame_pool.hpp"
 #include "singleton.hpp"
 #include <atomic>
+#include <chrono>
 #include <gazebo/gazebo_client.hh>
 #include <gazebo/transport/transport.hh>
-#include <mutex>
 #include <opencv2/opencv.hpp>
-#include <queue>
 #include <thread>
 
+// 图像接入模式
+enum class IngestMode
+{
+    GRAY, // 一次性将原始 RGB/L8 数据转换为帧池中的灰度图，BGR 仅在需要时生成
+    BGR   // 兼容模式：每帧转换为 BGR 彩色图，灰度图由下游自行转换
+};
+
 class CGazebo_camera
 {
 public:
@@ -17,17 +26,28 @@ public:
     void init(int argc, char **argv, const std::string &topic);
     void start();
     void stop();
-    cv::Mat GetNextFrame();
+    CameraFrame GetNextFrame();                                               // 阻塞直到有新帧或相机停止，总是返回最新帧
+    bool WaitNextFrame(FramePtr &frame, std::chrono::milliseconds timeout); // 限时等待最新帧，超时返回false
+
+    uint64_t droppedFrames() const; // 未被检测线程取走即被新帧覆盖的帧数
+    FrameBus &frameBus();           // 帧总线：录像、推流等其他消费者在此订阅自己的队列
+
+    void setIngestMode(IngestMode mode); // 设置图像接入模式
+    const FramePool &framePool() const;  // 获取帧池（用于查看分配统计）
 
 private:
     void ImageCallback(const boost::shared_ptr<const gazebo::msgs::ImageStamped> &_msg);
     void DisplayThread();
 
-    bool stopped_; // 停止标志
+    std::atomic<bool> stopped_; // 停止标志
+
+    std::atomic<IngestMode> ingest_mode_{IngestMode::GRAY}; // 图像接入模式
+    FramePool frame_pool_;                                  // 帧缓冲池
+    uint64_t frame_sequence_ = 0;                           // 帧序号（仅在回调线程中递增）
 
-    std::queue<cv::Mat> frame_queue_;
-    std::mutex queue_mutex_;
-    std::condition_variable queue_cond_;
+    FrameBus frame_bus_;                              // 采集→各消费者的帧广播总线
+    std::shared_ptr<FrameSubscription> detector_sub_; // 检测线程的订阅（只保留最新帧）
+    std::shared_ptr<FrameSubscription> display_sub_;  // 显示线程的订阅（只保留最新帧）
     std::atomic<bool> running_{false};
     std::thread display_thread_;
     std::string topic_;
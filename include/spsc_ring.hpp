@@ -0,0 +1,88 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 单生产者单消费者无锁环形队列
+ *
+ * 槽位在构造时一次性分配，tryPush / tryPop 都不加锁、不分配内存、不阻塞；
+ * 队列满时 tryPush 直接返回false，由生产者决定丢弃，保证生产者线程（如相机回调）从不等待消费者。
+ * 取出元素后槽位被重置为默认值，及时释放元素持有的资源（如帧缓冲区引用）。
+ */
+template <typename T>
+class SpscRing
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 最少可容纳的元素个数（向上取整为2的幂）
+     */
+    explicit SpscRing(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /**
+     * @brief 入队（仅生产者线程调用）
+     * @return 队列已满时返回false，元素未入队
+     */
+    bool tryPush(const T &value)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_)
+        {
+            return false;
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 出队（仅消费者线程调用）
+     * @return 队列为空时返回false
+     */
+    bool tryPop(T &out)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        T &slot = slots_[head & mask_];
+        out = std::move(slot);
+        slot = T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; } // 队列容量
+
+    // 当前元素个数（近似值，仅用于统计）
+    size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> slots_; // 元素槽位
+    size_t mask_ = 0;      // 容量-1
+
+    alignas(64) std::atomic<size_t> head_{0}; // 消费者读位置
+    alignas(64) std::atomic<size_t> tail_{0}; // 生产者写位置
+};
+
+#endif // SPSC_RING_HPP
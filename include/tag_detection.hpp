@@ -0,0 +1,16 @@
+#ifndef TAG_DETECTION_HPP
+#define TAG_DETECTION_HPP
+
+#include <opencv2/opencv.hpp>
+
+// 单个标签的检测结果（从检测器结果中复制，坐标为全帧坐标）
+struct TagDetection
+{
+    int id = 0;                   // 标签ID
+    int hamming = 0;              // 纠错位数
+    float decision_margin = 0.0f; // 解码置信度
+    cv::Point2f center;           // 标签中心
+    cv::Point2f corners[4];       // 四个角点（与 apriltag_detection_t::p 顺序一致）
+};
+
+#endif // TAG_DETECTION_HPP
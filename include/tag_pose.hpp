@@ -0,0 +1,62 @@
+#ifndef TAG_POSE_HPP
+#define TAG_POSE_HPP
+
+#include "tag_detection.hpp"
+
+#include <opencv2/opencv.hpp>
+
+// 相机内参（针孔模型，像素）
+struct CameraIntrinsics
+{
+    double fx = 0.0; // x 方向焦距
+    double fy = 0.0; // y 方向焦距
+    double cx = 0.0; // 主点 x
+    double cy = 0.0; // 主点 y
+
+    bool valid() const { return fx > 0.0 && fy > 0.0; }
+
+    // 由水平视场角和图像尺寸构造（方形像素、主点在图像中心），用于没有标定数据时
+    static CameraIntrinsics fromHorizontalFov(int width, int height, double hfov_rad);
+};
+
+// 飞行器姿态(度)，与 Telemetry::EulerAngle 一致
+struct VehicleAttitude
+{
+    float roll_deg = 0.0f;
+    float pitch_deg = 0.0f;
+    float yaw_deg = 0.0f;
+};
+
+// 标签（着陆板）相对飞行器的位姿
+struct TagPose
+{
+    bool valid = false;     // 是否有效
+    cv::Vec3d camera;       // 着陆板中心在相机坐标系下的位置(m)：x 右、y 下、z 沿光轴
+    cv::Matx33d rotation;   // 标签坐标系到相机坐标系的旋转
+    double forward_m = 0.0; // 水平坐标系（只含偏航的机体系）下的前向偏移(m)
+    double right_m = 0.0;   // 水平坐标系下的右向偏移(m)
+    double down_m = 0.0;    // 竖直向下距离(m)，即相对着陆板的高度
+    double north_m = 0.0;   // NED 北向偏移(m)
+    double east_m = 0.0;    // NED 东向偏移(m)
+    double m_per_px = 0.0;  // 着陆板所在深度处每像素对应的米数
+};
+
+/**
+ * @brief 由标签角点估计着陆板中心相对飞行器的位置
+ * @param det 检测结果（角点顺序与 apriltag_detection_t::p 一致）
+ * @param tag_size_m 标签边长(m)
+ * @param offset_x_m 标签中心相对着陆板中心的偏移，沿标签 x 轴(m)
+ * @param offset_y_m 标签中心相对着陆板中心的偏移，沿标签 y 轴(m)
+ * @param intrinsics 相机内参
+ * @param attitude 飞行器姿态（用于把相机系偏移转换到水平坐标系，补偿机体倾斜）
+ * @param pose 输出位姿
+ * @return 成功返回true
+ *
+ * 用 IPPE_SQUARE 由四个角点（即单应）求解标签的6自由度位姿，再按相机安装方式转换到机体系：
+ * 相机垂直向下安装，图像上方对应机头方向、图像右方对应机体右方、光轴对应机体下方。
+ * 机体系再经横滚、俯仰旋转到水平坐标系，经偏航旋转到 NED。
+ */
+bool estimateTagPose(const TagDetection &det, double tag_size_m, double offset_x_m, double offset_y_m,
+                     const CameraIntrinsics &intrinsics, const VehicleAttitude &attitude, TagPose &pose);
+
+#endif // TAG_POSE_HPP
@@ -20,6 +20,7 @@ namespace mavsdk
  * @brief 无人机遥测数据监控器，用于实时跟踪无人机状态
  *
  * 该类通过独立线程持续获取无人机位置、高度等信息，并提供线程安全的接口供其他模块查询当前状态。
+ * 位置、高度和姿态更新时发布 EVENT_TELEMETRY，唤醒控制线程。
  */
 class TelemetryMonitor
 {
@@ -0,0 +1,87 @@
+#ifndef TILED_DETECTOR_HPP
+#define TILED_DETECTOR_HPP
+
+#include "apriltag/apriltag.h"
+#include "detector_profile.hpp"
+#include "tag_detection.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/task_arena.h>
+#include <vector>
+
+// 分块并行检测参数
+struct TileParams
+{
+    bool enabled = false;  // 是否启用分块并行检测
+    int cols = 4;          // 列数
+    int rows = 2;          // 行数
+    int overlap_px = 96;   // 相邻分块的重叠宽度(像素)，应不小于画面中标签的最大边长
+    int concurrency = 0;   // 并行线程数（0表示使用全部核心）
+};
+
+/**
+ * @brief 分块并行AprilTag检测器
+ *
+ * 把搜索区域切成相互重叠的分块，每个分块由独立的检测器实例在专用的 TBB task_arena 中并行检测，
+ * 检测器按工作线程各建一个（单线程模式），整个检测流程（降采样、分割、拟合、解码）都随分块并行，
+ * 而不只是 AprilTag 库内部 nthreads 覆盖的几个阶段。
+ *
+ * 标签完整落在某个分块内才能被解码，重叠宽度不小于标签边长即可保证每个标签至少被一个分块完整覆盖；
+ * 跨越分块边界、在多个分块中重复检测到的同一标签只保留解码置信度最高的一个。
+ * 分块过小时自动减少行列数，搜索区域很小（如区域跟踪窗口）时退化为单块检测。
+ */
+class TiledTagDetector
+{
+public:
+    explicit TiledTagDetector(const TileParams &params);
+    ~TiledTagDetector();
+
+    TiledTagDetector(const TiledTagDetector &) = delete;
+    TiledTagDetector &operator=(const TiledTagDetector &) = delete;
+
+    /**
+     * @brief 分块检测
+     * @param gray 全帧灰度图（只读，分块复制到各线程的常驻缓冲区后检测）
+     * @param roi 搜索区域（全帧坐标）
+     * @param profile 检测器参数（nthreads 不生效，每个分块单线程检测）
+     * @return 去重后的检测结果（全帧坐标）
+     */
+    std::vector<TagDetection> detect(const cv::Mat &gray, const cv::Rect &roi, const DetectorProfile &profile);
+
+    const TileParams &params() const { return params_; }
+    int concurrency() const; // 实际并行线程数
+
+private:
+    // 每个工作线程独占的检测器及缓冲区
+    struct Worker
+    {
+        Worker();
+        ~Worker();
+
+        Worker(const Worker &) = delete;
+        Worker &operator=(const Worker &) = delete;
+
+        apriltag_family_t *tf = nullptr;   // 标签家族（快速解码表挂在家族上，不能在检测器之间共享）
+        apriltag_detector_t *td = nullptr; // 检测器
+        uint8_t *buffer = nullptr;         // 常驻分块缓冲区（行步长对齐）
+        size_t capacity = 0;               // 缓冲区容量(字节)
+    };
+
+    std::vector<cv::Rect> layoutTiles(const cv::Rect &roi) const;                          // 计算分块位置
+    static void detectTile(Worker &worker, const cv::Mat &gray, const cv::Rect &tile,
+                           const DetectorProfile &profile, std::vector<TagDetection> &out); // 检测单个分块
+    static std::vector<TagDetection> deduplicate(const std::vector<std::vector<TagDetection>> &per_tile); // 合并各分块结果并去重
+
+    TileParams params_;
+    std::unique_ptr<tbb::task_arena> arena_;                     // 专用线程池，不与其他 TBB 任务争抢
+    tbb::enumerable_thread_specific<Worker> workers_;            // 按线程创建的检测器
+    std::vector<std::vector<TagDetection>> tile_results_;        // 各分块的检测结果（按分块下标写入，无需加锁）
+
+    static constexpr size_t BUFFER_ALIGNMENT = 64; // 缓冲区对齐字节数
+};
+
+#endif // TILED_DETECTOR_HPP
@@ -16,6 +16,7 @@ struct UserTask
     bool landing_task_flag = false;
     bool waypoint_task_flag = false;
     bool land_mode_flag = false;
+    bool waypoint_landing_task_flag = false; // 航点任务完成后识别降落
     std::string mission_id; // 存储任务ID
 };
 extern UserTask user_task;
@@ -0,0 +1,364 @@
+#include "action_executor.hpp"
+#include "latency_histogram.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+using namespace mavsdk;
+
+ActionExecutor::~ActionExecutor()
+{
+    stop();
+}
+
+bool ActionExecutor::start(Action &action, Telemetry &telemetry, const ActionExecutorParams &params)
+{
+    if (running_)
+    {
+        return false;
+    }
+
+    action_ = &action;
+    telemetry_ = &telemetry;
+    params_ = params;
+    running_ = true;
+    thread_ = std::thread(&ActionExecutor::workerLoop, this);
+    return true;
+}
+
+void ActionExecutor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+std::shared_future<ActionOutcome> ActionExecutor::takeoff(float altitude_m, ActionCallback done)
+{
+    return submit(ActionPhase::SET_ALTITUDE, altitude_m, std::move(done));
+}
+
+std::shared_future<ActionOutcome> ActionExecutor::landAndDisarm(ActionCallback done)
+{
+    return submit(ActionPhase::LANDING, 0.0f, std::move(done));
+}
+
+void ActionExecutor::cancel()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (phase_ == ActionPhase::IDLE)
+    {
+        return;
+    }
+
+    ActionOutcome outcome;
+    outcome.message = "动作已取消: " + phaseToString(phase_);
+    phase_ = ActionPhase::IDLE;
+    ++command_id_; // 丢弃已发出命令的应答
+    command_pending_ = false;
+    command_done_ = false;
+    std::promise<ActionOutcome> promise = std::move(promise_);
+    ActionCallback callback = std::move(callback_);
+    callback_ = nullptr;
+    lock.unlock();
+
+    std::cout << outcome.message << std::endl;
+    promise.set_value(outcome);
+    if (callback)
+    {
+        callback(outcome);
+    }
+}
+
+/**
+ * @brief 提交动作
+ * @param first 动作的第一个阶段
+ * @param altitude_m 起飞高度（降落时不使用）
+ * @param done 完成回调
+ * @return 结果 future
+ *
+ * 只记录请求并进入第一个阶段，命令由执行线程在锁外发出，调用者不等待应答。
+ */
+std::shared_future<ActionOutcome> ActionExecutor::submit(ActionPhase first, float altitude_m, ActionCallback done)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!running_ || phase_ != ActionPhase::IDLE)
+    {
+        lock.unlock();
+        ActionOutcome outcome;
+        outcome.message = running_ ? "动作执行器忙: " + phaseToString(phase_) : "动作执行器未启动";
+        std::cerr << outcome.message << std::endl;
+        std::promise<ActionOutcome> rejected;
+        rejected.set_value(outcome);
+        if (done)
+        {
+            done(outcome);
+        }
+        return rejected.get_future().share();
+    }
+
+    promise_ = std::promise<ActionOutcome>();
+    callback_ = std::move(done);
+    altitude_m_ = altitude_m;
+    std::shared_future<ActionOutcome> future = promise_.get_future().share();
+    enter(first, steadyNowNs());
+    lock.unlock();
+
+    cv_.notify_all();
+    return future;
+}
+
+/**
+ * @brief 进入阶段（调用时持有 mutex_）
+ * @param phase 阶段
+ * @param now_ns 当前时刻
+ *
+ * 只更新状态并标记待发命令，命令由执行线程在释放 mutex_ 后发出。
+ */
+void ActionExecutor::enter(ActionPhase phase, int64_t now_ns)
+{
+    phase_ = phase;
+    phase_start_ns_ = now_ns;
+    on_ground_since_ns_ = 0;
+    command_done_ = false;
+    ++command_id_;
+    command_pending_ = true;
+}
+
+/**
+ * @brief 发出阶段的异步命令（调用时不持有 mutex_，只在执行线程中调用）
+ * @param phase 阶段
+ * @param id 命令编号
+ *
+ * 部分 *_async 接口（如 set_takeoff_altitude_async）在调用线程中同步完成并直接回调，
+ * 回调需要获取 mutex_，因此不能在持锁时调用。
+ * 应答在 MAVSDK 线程中回调，只记录结果，阶段推进统一在执行线程中进行。
+ */
+void ActionExecutor::sendCommand(ActionPhase phase, uint64_t id)
+{
+    const auto on_result = [this, id](Action::Result result)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (id == command_id_)
+        {
+            command_result_ = result;
+            command_done_ = true;
+        }
+        cv_.notify_all();
+    };
+
+    switch (phase)
+    {
+        case ActionPhase::SET_ALTITUDE:
+            std::cout << "起飞高度设置为: " << altitude_m_ << " 米\n";
+            action_->set_takeoff_altitude_async(altitude_m_, on_result);
+            break;
+        case ActionPhase::ARMING:
+            std::cout << "准备解锁...\n";
+            action_->arm_async(on_result);
+            break;
+        case ActionPhase::TAKING_OFF:
+            std::cout << "开始起飞...\n";
+            action_->takeoff_async(on_result);
+            break;
+        case ActionPhase::LANDING:
+            std::cout << "\n开始降落...\n";
+            action_->land_async(on_result);
+            break;
+        case ActionPhase::DISARMING:
+            std::cout << "降落完成，正在上锁...\n";
+            action_->disarm_async(on_result);
+            break;
+        default:
+            break; // 等待着地等阶段没有命令
+    }
+}
+
+/**
+ * @brief 推进当前阶段（调用时持有 mutex_）
+ * @param now_ns 当前时刻
+ * @param outcome 动作结束时输出结果
+ * @return 动作结束（成功或失败）返回true
+ */
+bool ActionExecutor::step(int64_t now_ns, ActionOutcome &outcome)
+{
+    const ActionPhase phase = phase_;
+    const double elapsed_s = (now_ns - phase_start_ns_) * 1e-9;
+
+    if (phase == ActionPhase::IDLE)
+    {
+        return false;
+    }
+
+    if (phase == ActionPhase::WAIT_LANDED)
+    {
+        // 飞控报告着地状态时以其为准，不支持时退化为 in_air
+        const Telemetry::LandedState landed_state = telemetry_->landed_state();
+        const bool on_ground = landed_state == Telemetry::LandedState::Unknown ? !telemetry_->in_air()
+                                                                               : landed_state == Telemetry::LandedState::OnGround;
+        if (!on_ground)
+        {
+            on_ground_since_ns_ = 0;
+        }
+        else if (on_ground_since_ns_ == 0)
+        {
+            on_ground_since_ns_ = now_ns;
+        }
+        else if ((now_ns - on_ground_since_ns_) * 1e-9 >= params_.on_ground_hold_s)
+        {
+            enter(ActionPhase::DISARMING, now_ns);
+            return false;
+        }
+
+        if (elapsed_s > params_.land_timeout_s)
+        {
+            outcome.message = "降落超时，未检测到着地";
+            return true;
+        }
+        return false;
+    }
+
+    // 其余阶段等待命令应答
+    if (!command_done_)
+    {
+        if (elapsed_s > params_.command_timeout_s)
+        {
+            outcome.message = phaseToString(phase) + " 命令应答超时";
+            return true;
+        }
+        return false;
+    }
+    if (command_result_ != Action::Result::Success)
+    {
+        std::ostringstream text;
+        text << phaseToString(phase) << " 失败: " << command_result_;
+        outcome.message = text.str();
+        return true;
+    }
+
+    switch (phase)
+    {
+        case ActionPhase::SET_ALTITUDE:
+            enter(ActionPhase::ARMING, now_ns);
+            return false;
+        case ActionPhase::ARMING:
+            std::cout << "无人机已解锁，电机运行中...\n";
+            enter(ActionPhase::TAKING_OFF, now_ns);
+            return false;
+        case ActionPhase::TAKING_OFF:
+            outcome.success = true;
+            outcome.message = "起飞命令已执行";
+            return true;
+        case ActionPhase::LANDING:
+            enter(ActionPhase::WAIT_LANDED, now_ns);
+            return false;
+        case ActionPhase::DISARMING:
+            outcome.success = true;
+            outcome.message = "无人机已安全上锁";
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief 执行线程主循环
+ *
+ * 有待发命令或命令应答时立即处理，否则按 tick_hz 检查超时和着地状态；
+ * 命令的发出、future 的兑现和回调都在锁外进行。
+ */
+void ActionExecutor::workerLoop()
+{
+    const auto tick = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / params_.tick_hz));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_)
+    {
+        cv_.wait_for(lock, tick, [this]()
+                     { return !running_ || command_pending_ || (command_done_ && phase_ != ActionPhase::IDLE); });
+        if (!running_)
+        {
+            break;
+        }
+
+        if (command_pending_)
+        {
+            command_pending_ = false;
+            const ActionPhase phase = phase_;
+            const uint64_t id = command_id_;
+            lock.unlock();
+            sendCommand(phase, id);
+            lock.lock();
+            continue;
+        }
+
+        ActionOutcome outcome;
+        if (!step(steadyNowNs(), outcome))
+        {
+            continue;
+        }
+
+        // 动作结束：先回到空闲（回调中可以提交下一个动作），再在锁外通知调用者
+        phase_ = ActionPhase::IDLE;
+        ++command_id_;
+        command_done_ = false;
+        std::promise<ActionOutcome> promise = std::move(promise_);
+        ActionCallback callback = std::move(callback_);
+        callback_ = nullptr;
+        lock.unlock();
+
+        (outcome.success ? std::cout : std::cerr) << outcome.message << std::endl;
+        promise.set_value(outcome);
+        if (callback)
+        {
+            callback(outcome);
+        }
+        lock.lock();
+    }
+
+    // 停止时进行中的动作以失败结束，避免调用者永远等待
+    if (phase_ != ActionPhase::IDLE)
+    {
+        phase_ = ActionPhase::IDLE;
+        ActionOutcome outcome;
+        outcome.message = "动作执行器已停止";
+        std::promise<ActionOutcome> promise = std::move(promise_);
+        ActionCallback callback = std::move(callback_);
+        lock.unlock();
+        promise.set_value(outcome);
+        if (callback)
+        {
+            callback(outcome);
+        }
+    }
+}
+
+std::string ActionExecutor::phaseToString(ActionPhase phase)
+{
+    switch (phase)
+    {
+        case ActionPhase::IDLE:
+            return "IDLE";
+        case ActionPhase::SET_ALTITUDE:
+            return "SET_ALTITUDE";
+        case ActionPhase::ARMING:
+            return "ARMING";
+        case ActionPhase::TAKING_OFF:
+            return "TAKING_OFF";
+        case ActionPhase::LANDING:
+            return "LANDING";
+        case ActionPhase::WAIT_LANDED:
+            return "WAIT_LANDED";
+        case ActionPhase::DISARMING:
+            return "DISARMING";
+        default:
+            return "UNKNOWN";
+    }
+}
@@ -1,11 +1,19 @@
 #include "apriltag_tracker.hpp"
+#include "event_flags.hpp"
+#include "frame_recorder.hpp"
+#include "latency_histogram.hpp"
+
+#include <cstdlib>
+#include <limits>
+
+#ifdef SIMULATION
 #include "sim_camera_module.hpp"
 
 // Gazebo仿真环境中相机图像主题
 std::string subscribePtr = "/gazebo/default/iris/base_link/camera/image";
 
 // 获取最新帧函数（仿真模式专用）
-cv::Mat get_latest_frame()
+CameraFrame get_latest_frame()
 {
     return GazeboCamera::Instance()->GetNextFrame(); // 从Gazebo仿真相机获取最新图像帧
 }
@@ -16,6 +24,66 @@ void AprilTagTracker::GazeboStart(int argc, char *argv[])
     // 初始化并启动Gazebo相机
     GazeboCamera::Instance()->init(argc, argv, subscribePtr);
     GazeboCamera::Instance()->start();
+
+    // 启动检测线程
+    if (!running_.exchange(true))
+    {
+        vision_thread_ = std::thread(&AprilTagTracker::visionLoop, this);
+    }
+}
+
+/**
+ * @brief 检测线程：等待最新帧并检测，结果带时间戳发布给控制循环
+ * 帧时间预算调节器跳过已经过旧的帧，并按检测耗时调整降采样等级（在 detect() 选择档位时生效）
+ */
+void AprilTagTracker::visionLoop()
+{
+    while (running_)
+    {
+        FramePtr frame; // 与显示、录像等其他订阅者共享的只读帧
+        if (!GazeboCamera::Instance()->WaitNextFrame(frame, std::chrono::milliseconds(100)))
+        {
+            continue; // 超时后重新检查运行标志
+        }
+
+        if (!_governor.admit(frame->sequence, frame->capture_ns, steadyNowNs()))
+        {
+            continue; // 帧已过旧，等待下一帧
+        }
+
+        AprilTagData result = detect(*frame, false);
+        if (result.detect_end_ns > 0)
+        {
+            // 只有完整检测的耗时参与调节；画面复用和光流跟踪只需微秒级，计入会掩盖完整检测的超预算
+            if (result.reused || result.tracked)
+            {
+                _governor.completeLight(result.detect_end_ns);
+            }
+            else
+            {
+                _governor.complete(result.detect_start_ns, result.detect_end_ns);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(data_mutex_);
+            _latest_output = result;
+        }
+        control_events::Instance()->post(EVENT_DETECTION); // 唤醒控制线程立即处理新结果
+    }
+}
+#endif // SIMULATION
+
+/**
+ * @brief 停止检测线程
+ */
+void AprilTagTracker::stop()
+{
+    running_ = false;
+    if (vision_thread_.joinable())
+    {
+        vision_thread_.join();
+    }
 }
 
 namespace
@@ -96,11 +164,29 @@ namespace
         return (max_edge / min_edge <= max_edge_ratio);
     }
 
-    // 多目标检测状态标记（仅在当前编译单元内可见）
-    bool detect_twotag = false; // true表示当前帧检测到两个AprilTag目标
+    // 根据标签中心计算与图像中心的偏差
+    void computeErrors(AprilTagData &result)
+    {
+        result.err_x = (result.height / 2.0) - result.y; // X方向偏差
+        result.err_y = (result.width / 2.0) - result.x;  // Y方向偏差
+
+        // 相对于图像全宽 / 全高归一化（结果范围 [-0.5, 0.5]）：
+        result.norm_err_x = result.err_x / result.width;
+        result.norm_err_y = result.err_y / result.height;
+    }
+
+    // 写入本帧的采集和检测时间戳
+    void stampResult(AprilTagData &result, const CameraFrame &frame, int64_t start_ns, int64_t end_ns)
+    {
+        result.sequence = frame.sequence;
+        result.capture_ns = frame.capture_ns;
+        result.sim_ns = frame.sim_ns;
+        result.detect_start_ns = start_ns;
+        result.detect_end_ns = end_ns;
+    }
 }
 
-AprilTagTracker::AprilTagTracker()
+AprilTagTracker::AprilTagTracker() : running_(false), _relative_altitude(std::numeric_limits<float>::quiet_NaN())
 {
     tf = tag25h9_create();
     td = apriltag_detector_create();
@@ -116,10 +202,15 @@ AprilTagTracker::AprilTagTracker()
     td->refine_edges = true;
     td->decode_sharpening = 0.75; // 锐化解码区域
     td->quad_sigma = 0.2;         // 增加高斯模糊
+
+    // 起飞前高度未知，使用最精细的档位
+    applyProfile(_profile_scheduler.current());
 }
 
 AprilTagTracker::~AprilTagTracker()
 {
+    stop();
+
     // 释放AprilTag资源（先释放标签家族，再释放检测器）
     if (tf)
     {
@@ -132,13 +223,977 @@ AprilTagTracker::~AprilTagTracker()
 }
 
 /**
- * @brief 主检测函数：从图像中检测AprilTag标签并计算其位置
+ * @brief 检测函数：从OpenCV图像中检测AprilTag标签
  * @param frame 输入图像帧（BGR或灰度图）
  * @param drawOverlay 是否绘制检测结果叠加层
  * @return 包含检测结果的AprilTagData结构体
  */
 AprilTagData AprilTagTracker::detect(cv::Mat &frame, bool drawOverlay)
 {
+    CameraFrame wrapped;
+    if (frame.channels() == 3)
+    {
+        wrapped.color = frame;
+        wrapped.color_format = FramePixelFormat::BGR8;
+    }
+    else
+    {
+        wrapped.gray = frame;
+    }
+    return detect(wrapped, drawOverlay);
+}
+
+/**
+ * @brief 设置区域跟踪参数
+ * @param params 区域跟踪参数
+ */
+void AprilTagTracker::setRoiTracking(const RoiTrackingParams &params)
+{
+    _roi_params = params;
+    resetTrack();
+}
+
+/**
+ * @brief 重置区域跟踪状态，下一帧回到全图搜索
+ */
+void AprilTagTracker::resetTrack()
+{
+    _track_valid = false;
+    _track_misses = 0;
+    _track_velocity = cv::Point2f(0.0f, 0.0f);
+    _flow_valid = false;
+}
+
+/**
+ * @brief 更新当前相对高度
+ * @param altitude_m 相对起飞点高度(m)
+ */
+void AprilTagTracker::setRelativeAltitude(float altitude_m)
+{
+    _relative_altitude = altitude_m;
+}
+
+/**
+ * @brief 获取当前生效的检测器档位（可在其他线程调用）
+ */
+DetectorProfile AprilTagTracker::activeProfile() const
+{
+    std::lock_guard<std::mutex> lock(profile_mutex_);
+    return _active_profile;
+}
+
+/**
+ * @brief 获取当前时刻的标签结果
+ * @return 滤波器有效时返回外推到当前时刻的标签位置（id、面积和时间戳沿用最后一次检测）；
+ *         否则返回检测线程最新一次的输出
+ *
+ * 控制循环可以比检测更快地调用：两次检测之间以及短暂遮挡期间得到的是平滑的预测值，而不是重复的旧结果。
+ */
+AprilTagData AprilTagTracker::process()
+{
+    AprilTagData output;
+    AprilTagData last_found;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        output = _latest_output;
+        last_found = _last_results;
+    }
+
+    TagEstimate estimate;
+    if (!last_found.iffind || !predictTag(steadyNowNs(), estimate))
+    {
+        return output;
+    }
+
+    const double measured_err_x = last_found.err_x;
+    const double measured_err_y = last_found.err_y;
+    last_found.x = estimate.x;
+    last_found.y = estimate.y;
+    computeErrors(last_found);
+
+    // 米制偏差按预测的像素位移和着陆板处的像素尺度同步外推
+    if (last_found.pose_valid)
+    {
+        last_found.err_x_m += (last_found.err_x - measured_err_x) * last_found.m_per_px;
+        last_found.err_y_m += (last_found.err_y - measured_err_y) * last_found.m_per_px;
+    }
+    return last_found;
+}
+
+/**
+ * @brief 预测任意时刻的标签状态
+ * @param t_ns 查询时刻（steady_clock 纳秒）
+ * @param estimate 输出：预测的位置、速度及协方差
+ * @return 滤波器未初始化或距最后一次检测超过 max_coast_s 时返回false
+ */
+bool AprilTagTracker::predictTag(int64_t t_ns, TagEstimate &estimate) const
+{
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+
+    Filter::ConstantVelocityKalman2D::State state;
+    if (!_tag_filter.predict(t_ns, state))
+    {
+        estimate = TagEstimate();
+        return false;
+    }
+
+    estimate.id = _filter_id;
+    estimate.x = static_cast<float>(state.x[0]);
+    estimate.y = static_cast<float>(state.x[1]);
+    estimate.vx = static_cast<float>(state.x[2]);
+    estimate.vy = static_cast<float>(state.x[3]);
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            estimate.cov[i][j] = state.P[i][j];
+        }
+    }
+    estimate.age_s = std::max(0.0, (t_ns - _tag_filter.lastUpdateNs()) * 1e-9);
+    estimate.valid = estimate.age_s <= _filter_params.max_coast_s;
+    return estimate.valid;
+}
+
+/**
+ * @brief 设置标签状态滤波参数
+ * @param params 滤波参数
+ */
+void AprilTagTracker::setTagFilter(const TagFilterParams &params)
+{
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+    _filter_params = params;
+    _tag_filter = Filter::ConstantVelocityKalman2D(params.accel_noise_px, params.measurement_noise_px, params.initial_velocity_px);
+    _filter_id = -1;
+}
+
+/**
+ * @brief 替换检测器档位表并立即应用新的当前档位
+ * @param profiles 档位表（只给一个档位时即固定使用该参数，用于离线基准测试）
+ */
+void AprilTagTracker::setDetectorProfiles(const std::vector<DetectorProfile> &profiles)
+{
+    _profile_scheduler.setProfiles(profiles);
+    applyProfile(_profile_scheduler.current());
+}
+
+/**
+ * @brief 设置金字塔检测参数
+ * @param params 金字塔检测参数（enabled为false时与原先一样直接在搜索区域内检测）
+ */
+void AprilTagTracker::setPyramidMode(const PyramidParams &params)
+{
+    _pyramid_params = params;
+}
+
+/**
+ * @brief 设置分块并行检测参数（启用时优先于金字塔检测）
+ * @param params 分块参数（enabled为false时释放分块检测器）
+ */
+void AprilTagTracker::setTileMode(const TileParams &params)
+{
+    _tiled.reset(params.enabled ? new TiledTagDetector(params) : nullptr);
+}
+
+/**
+ * @brief 设置帧变化门控参数（下一帧必定重新检测）
+ * @param params 门控参数
+ */
+void AprilTagTracker::setChangeGate(const ChangeGateParams &params)
+{
+    _change_gate.setParams(params);
+    _frame_result_valid = false;
+}
+
+/**
+ * @brief 获取因画面未变化而复用结果的帧数（可在其他线程调用）
+ */
+uint64_t AprilTagTracker::reusedFrames() const
+{
+    return _reused_frames.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 设置着陆板布局（须在检测线程启动前设置）
+ * @param tags 着陆板上各标签的尺寸和偏移，为空时每个标签都视为板中心（单标签模式）
+ */
+void AprilTagTracker::setPadLayout(const std::vector<PadTag> &tags)
+{
+    _pad.setTags(tags);
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+    _tag_filter.reset();
+    _filter_id = -1;
+}
+
+/**
+ * @brief 从文件加载着陆板布局（须在检测线程启动前调用）
+ * @param path YAML/JSON 文件路径（格式见 LandingPad::load）
+ * @return 加载成功返回true
+ */
+bool AprilTagTracker::loadPadLayout(const std::string &path)
+{
+    if (!_pad.load(path))
+    {
+        return false;
+    }
+    setPadLayout(_pad.tags());
+    return true;
+}
+
+/**
+ * @brief 设置光流跟踪参数
+ * @param params 光流参数（enabled为false时每帧完整检测）
+ */
+void AprilTagTracker::setFlowTracking(const FlowTrackingParams &params)
+{
+    _flow_params = params;
+    _flow_valid = false;
+    _tracked_frames.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 获取由光流跟踪得到结果的帧数（可在其他线程调用）
+ */
+uint64_t AprilTagTracker::trackedFrames() const
+{
+    return _tracked_frames.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 光流跟踪上一帧所选标签的角点
+ * @param gray 本帧灰度图
+ * @param detections 输出跟踪得到的标签（只有一个）
+ * @param confidence 输出置信度
+ * @return 跟踪成功返回true；需要完整检测（到了检测间隔、置信度过低或跟踪失败）时返回false
+ *
+ * 只在参考角点附近的局部区域建金字塔（区域覆盖金字塔能跟上的最大位移），正向跟踪后再反向跟踪回参考帧，
+ * 任一点丢失或前后向误差超限即判为失败。每帧耗时在百微秒量级，远低于一次解码。
+ */
+bool AprilTagTracker::trackFlow(const cv::Mat &gray, std::vector<TagDetection> &detections, float &confidence)
+{
+    if (!_flow_params.enabled || !_flow_valid || _flow_run + 1 >= _flow_params.detect_interval ||
+        _flow_confidence < _flow_params.min_confidence || _flow_prev.size() != gray.size())
+    {
+        return false;
+    }
+
+    std::vector<cv::Point2f> prev_points(_flow_tag.corners, _flow_tag.corners + 4);
+    prev_points.push_back(_flow_tag.center);
+    const cv::Rect box = cv::boundingRect(prev_points);
+    const int margin = std::max(std::max(box.width, box.height), (_flow_params.win_size << _flow_params.max_level) / 2);
+    const cv::Rect region = cv::Rect(box.x - margin, box.y - margin, box.width + 2 * margin, box.height + 2 * margin) &
+                            cv::Rect(0, 0, gray.cols, gray.rows);
+    if (region.width < _flow_params.win_size || region.height < _flow_params.win_size)
+    {
+        return false;
+    }
+    const cv::Point2f offset(static_cast<float>(region.x), static_cast<float>(region.y));
+    for (cv::Point2f &p : prev_points)
+    {
+        p -= offset;
+    }
+
+    const cv::Size win(_flow_params.win_size, _flow_params.win_size);
+    const int levels = std::min(cv::buildOpticalFlowPyramid(_flow_prev(region), _flow_prev_pyramid, win, _flow_params.max_level),
+                                cv::buildOpticalFlowPyramid(gray(region), _flow_next_pyramid, win, _flow_params.max_level));
+    const cv::TermCriteria criteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 20, 0.03);
+
+    std::vector<cv::Point2f> next_points, back_points;
+    std::vector<uchar> status, back_status;
+    std::vector<float> error;
+    cv::calcOpticalFlowPyrLK(_flow_prev_pyramid, _flow_next_pyramid, prev_points, next_points, status, error, win, levels, criteria);
+    cv::calcOpticalFlowPyrLK(_flow_next_pyramid, _flow_prev_pyramid, next_points, back_points, back_status, error, win, levels, criteria);
+
+    float max_fb_error = 0.0f;
+    for (size_t i = 0; i < prev_points.size(); ++i)
+    {
+        if (!status[i] || !back_status[i])
+        {
+            return false;
+        }
+        const cv::Point2f d = back_points[i] - prev_points[i];
+        max_fb_error = std::max(max_fb_error, std::sqrt(d.x * d.x + d.y * d.y));
+    }
+    if (max_fb_error > _flow_params.max_fb_error_px)
+    {
+        return false;
+    }
+
+    TagDetection tracked = _flow_tag;
+    for (int k = 0; k < 4; ++k)
+    {
+        tracked.corners[k] = next_points[k] + offset;
+    }
+    tracked.center = next_points[4] + offset;
+
+    const float prev_area = calculateQuadrilateralArea(_flow_tag.corners);
+    const float area = calculateQuadrilateralArea(tracked.corners);
+    if (prev_area <= 0.0f || std::abs(area - prev_area) > _flow_params.max_area_change * prev_area)
+    {
+        return false;
+    }
+
+    // 漂移随跟踪帧数累积：置信度按本帧前后向误差相乘衰减，完整检测时恢复为1
+    confidence = _flow_confidence * (1.0f - 0.5f * max_fb_error / _flow_params.max_fb_error_px);
+    detections.assign(1, tracked);
+    return true;
+}
+
+/**
+ * @brief 设置检测线程的帧时间预算
+ * @param params 预算参数（enabled为false时只统计，不跳帧也不降采样）
+ */
+void AprilTagTracker::setDeadline(const DeadlineParams &params)
+{
+    _governor.setParams(params);
+}
+
+/**
+ * @brief 获取帧时间预算统计（可在其他线程调用）
+ */
+DeadlineStats AprilTagTracker::deadlineStats() const
+{
+    return _governor.stats();
+}
+
+/**
+ * @brief 设置米制位姿估计参数
+ * @param params 位姿参数（着陆板布局中的标签使用布局中的尺寸和偏移）
+ */
+void AprilTagTracker::setTagPose(const TagPoseParams &params)
+{
+    _pose_params = params;
+}
+
+/**
+ * @brief 更新飞行器姿态（控制线程调用）
+ * @param attitude 当前姿态
+ */
+void AprilTagTracker::setAttitude(const VehicleAttitude &attitude)
+{
+    std::lock_guard<std::mutex> lock(attitude_mutex_);
+    _attitude = attitude;
+}
+
+/**
+ * @brief 加载相机标定
+ * @param path 标定文件路径（格式见 CameraCalibration::load）
+ * @return 加载成功返回true
+ *
+ * 加载后检测结果的板中心、像素偏差和米制位姿都按去畸变后的几何计算；搜索窗口和录像仍使用原始图像坐标。
+ */
+bool AprilTagTracker::loadCalibration(const std::string &path)
+{
+    return _calibration.load(path);
+}
+
+/**
+ * @brief 估计所选标签对应的着陆板米制位置
+ * @param result 检测结果（填写米制字段）
+ * @param det 所选标签
+ * @param frame_size 图像尺寸
+ */
+void AprilTagTracker::estimatePose(AprilTagData &result, const TagDetection &det, const cv::Size &frame_size)
+{
+    result.pose_valid = false;
+    if (!_pose_params.enabled)
+    {
+        return;
+    }
+
+    double size_m = _pose_params.tag_size_m;
+    double offset_x_m = 0.0;
+    double offset_y_m = 0.0;
+    if (const PadTag *tag = _pad.find(det.id))
+    {
+        size_m = tag->size_m;
+        offset_x_m = tag->offset_x_m;
+        offset_y_m = tag->offset_y_m;
+    }
+
+    CameraIntrinsics intrinsics = _calibration.ready() ? _calibration.intrinsics() : _pose_params.intrinsics; // 去畸变后的角点须配合标定内参
+    if (!intrinsics.valid())
+    {
+        intrinsics = CameraIntrinsics::fromHorizontalFov(frame_size.width, frame_size.height, _pose_params.hfov_rad);
+    }
+    VehicleAttitude attitude;
+    {
+        std::lock_guard<std::mutex> lock(attitude_mutex_);
+        attitude = _attitude;
+    }
+
+    TagPose pose;
+    if (!estimateTagPose(det, size_m, offset_x_m, offset_y_m, intrinsics, attitude, pose))
+    {
+        return;
+    }
+    result.pose_valid = true;
+    result.err_x_m = pose.forward_m; // 与 err_x 同向：着陆板在前方时为正
+    result.err_y_m = -pose.right_m;  // 与 err_y 同向：着陆板在左方时为正
+    result.north_m = pose.north_m;
+    result.east_m = pose.east_m;
+    result.height_m = pose.down_m;
+    result.m_per_px = pose.m_per_px;
+}
+
+/**
+ * @brief 设置级联检测参数
+ * @param params 级联参数（enabled为false时与原先一样直接检测）
+ */
+void AprilTagTracker::setCascade(const CascadeParams &params)
+{
+    _cascade_params = params;
+    _cascade_rejected_run = 0;
+    for (std::atomic<uint64_t> *counter : {&_cascade_counters.frames, &_cascade_counters.rejected, &_cascade_counters.fallbacks,
+                                           &_cascade_counters.regions, &_cascade_counters.region_hits, &_cascade_counters.region_misses,
+                                           &_cascade_counters.audits, &_cascade_counters.audit_misses})
+    {
+        counter->store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 获取级联检测统计（可在其他线程调用）
+ */
+CascadeStats AprilTagTracker::cascadeStats() const
+{
+    CascadeStats stats;
+    stats.frames = _cascade_counters.frames.load(std::memory_order_relaxed);
+    stats.rejected = _cascade_counters.rejected.load(std::memory_order_relaxed);
+    stats.fallbacks = _cascade_counters.fallbacks.load(std::memory_order_relaxed);
+    stats.regions = _cascade_counters.regions.load(std::memory_order_relaxed);
+    stats.region_hits = _cascade_counters.region_hits.load(std::memory_order_relaxed);
+    stats.region_misses = _cascade_counters.region_misses.load(std::memory_order_relaxed);
+    stats.audits = _cascade_counters.audits.load(std::memory_order_relaxed);
+    stats.audit_misses = _cascade_counters.audit_misses.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief 获取最近一次 detect() 中通过几何验证的标签（未检测到时为空，不包含超时保持的旧结果）
+ */
+const std::vector<TagDetection> &AprilTagTracker::lastDetections() const
+{
+    return _frame_detections;
+}
+
+/**
+ * @brief 切换检测器参数
+ * @param profile 目标档位
+ *
+ * 只修改检测器字段，线程池在下一次检测时由AprilTag库按 nthreads 自动重建，无需重新创建检测器。
+ */
+void AprilTagTracker::applyProfile(const DetectorProfile &profile)
+{
+    td->quad_decimate = profile.quad_decimate;
+    td->quad_sigma = profile.quad_sigma;
+    td->nthreads = profile.nthreads;
+
+    std::lock_guard<std::mutex> lock(profile_mutex_);
+    _active_profile = profile;
+}
+
+/**
+ * @brief 计算本帧的搜索区域
+ * @param frame_size 图像尺寸
+ * @return 跟踪有效时返回上一次检测位置附近的搜索窗口，否则返回全图
+ *
+ * 窗口以按速度外推的标签中心为中心，半宽为标签尺寸的倍数加上与速度成比例的余量，
+ * 保证标签在帧间移动时仍完整落在窗口内。
+ */
+cv::Rect AprilTagTracker::searchWindow(const cv::Size &frame_size) const
+{
+    const cv::Rect full(0, 0, frame_size.width, frame_size.height);
+    if (!_roi_params.enabled || !_track_valid)
+    {
+        return full;
+    }
+
+    const cv::Point2f predicted = _track_center + _track_velocity; // 按恒速外推本帧中心
+    const float half = _track_size * _roi_params.size_factor +
+                       _roi_params.velocity_gain * std::max(std::abs(_track_velocity.x), std::abs(_track_velocity.y)) +
+                       _roi_params.min_margin;
+
+    cv::Rect window(cvRound(predicted.x - half), cvRound(predicted.y - half), cvRound(2 * half), cvRound(2 * half));
+    window &= full;
+
+    // 窗口过小或覆盖了大部分画面时直接全图搜索
+    if (window.width < _roi_params.min_window || window.height < _roi_params.min_window ||
+        window.area() > full.area() * 0.6)
+    {
+        return full;
+    }
+    return window;
+}
+
+/**
+ * @brief 在指定区域内运行AprilTag检测器
+ * @param gray 全帧灰度图
+ * @param roi 搜索区域（全帧坐标）
+ * @return 检测结果，角点和中心已映射回全帧坐标
+ */
+std::vector<TagDetection> AprilTagTracker::runDetector(const cv::Mat &gray, const cv::Rect &roi)
+{
+    std::vector<TagDetection> out;
+    const cv::Mat region = gray(roi); // 区域视图（不复制）
+
+    // 优先直接在Mat数据上构造AprilTag图像视图（零拷贝），不满足条件时复制到常驻缓冲区
+    const bool direct = canViewDirectly(region);
+    image_u8_t image = direct ? image_u8_t{region.cols, region.rows, static_cast<int32_t>(region.step), region.data}
+                              : prepareDetectionBuffer(region.cols, region.rows);
+    image_u8_t *im = &image;
+    if (!direct)
+    {
+        // 将OpenCV图像数据复制到AprilTag缓冲区
+        for (int y = 0; y < region.rows; ++y)
+        {
+            memcpy(im->buf + y * im->stride,
+                   region.ptr(y),
+                   region.cols);
+        }
+    }
+
+    // 执行标签检测算法
+    zarray_t *detections = apriltag_detector_detect(td, im); // 调用AprilTag库检测函数
+
+    out.reserve(zarray_size(detections));
+    for (int i = 0; i < zarray_size(detections); ++i)
+    {
+        apriltag_detection_t *det;
+        zarray_get(detections, i, &det); // 提取单个检测结果
+
+        // 复制检测结果并平移回全帧坐标
+        TagDetection tag;
+        tag.id = det->id;
+        tag.hamming = det->hamming;
+        tag.decision_margin = det->decision_margin;
+        tag.center = cv::Point2f(static_cast<float>(det->c[0] + roi.x), static_cast<float>(det->c[1] + roi.y));
+        for (int k = 0; k < 4; ++k)
+        {
+            tag.corners[k] = cv::Point2f(static_cast<float>(det->p[k][0] + roi.x), static_cast<float>(det->p[k][1] + roi.y));
+        }
+        out.push_back(tag);
+    }
+
+    // 释放检测资源（图像缓冲区常驻复用，不释放）
+    apriltag_detections_destroy(detections);
+    return out;
+}
+
+/**
+ * @brief 金字塔检测：在降采样图上找候选四边形，只对候选区域以全分辨率解码
+ * @param gray 全帧灰度图
+ * @param roi 搜索区域（全帧坐标）
+ * @return 检测结果（全帧坐标），与 runDetector 相同
+ *
+ * 候选区域过多或总面积过大时（纹理复杂、标签占满画面）直接按原方式检测整个搜索区域，
+ * 候选区域内检测时临时关闭检测器降采样，解码和角点拟合都在全分辨率上完成。
+ */
+std::vector<TagDetection> AprilTagTracker::runPyramid(const cv::Mat &gray, const cv::Rect &roi)
+{
+    const float scale = _pyramid_params.scale > 0.0f ? _pyramid_params.scale : std::max(2.0f, _active_profile.quad_decimate);
+
+    // 粗检测：面积插值降采样（抗混叠，细线不会断开）
+    cv::Mat coarse;
+    cv::resize(gray(roi), coarse, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+    std::vector<cv::Rect> candidates = findQuadCandidates(coarse, scale, _pyramid_params.min_quad_side, _pyramid_params.margin_ratio, 0.0f);
+
+    double candidate_area = 0.0;
+    for (cv::Rect &rect : candidates)
+    {
+        rect.x += roi.x;
+        rect.y += roi.y;
+        rect &= roi;
+        candidate_area += rect.area();
+    }
+
+    const bool too_many = static_cast<int>(candidates.size()) > _pyramid_params.max_candidates ||
+                          candidate_area > _pyramid_params.max_area_ratio * roi.area();
+    // 跟踪中的标签在粗检测图上丢失时也退回整幅检测，避免金字塔模式比原方式更早丢失目标
+    const bool lost = candidates.empty() && _track_valid;
+    if (too_many || lost)
+    {
+        std::vector<TagDetection> out = runDetector(gray, roi);
+        if (_pyramid_params.subpixel)
+        {
+            refineCorners(gray, out);
+        }
+        return out;
+    }
+
+    // 候选区域以全分辨率解码：临时关闭降采样，离开作用域时恢复（OpenCV 或解码器抛出异常时也不会停留在 1）
+    struct DecimateGuard
+    {
+        apriltag_detector_t *detector;
+        float saved;
+        ~DecimateGuard() { detector->quad_decimate = saved; }
+    };
+
+    std::vector<TagDetection> out;
+    {
+        const DecimateGuard guard{td, td->quad_decimate};
+        td->quad_decimate = 1.0f;
+        for (const cv::Rect &rect : candidates)
+        {
+            if (rect.width < 8 || rect.height < 8)
+            {
+                continue;
+            }
+            for (const TagDetection &det : runDetector(gray, rect))
+            {
+                // 相邻候选区域的外扩部分可能重叠，同一标签只保留一次
+                bool duplicate = false;
+                for (const TagDetection &kept : out)
+                {
+                    const cv::Point2f d = kept.center - det.center;
+                    if (kept.id == det.id && d.x * d.x + d.y * d.y < 4.0f)
+                    {
+                        duplicate = true;
+                        break;
+                    }
+                }
+                if (!duplicate)
+                {
+                    out.push_back(det);
+                }
+            }
+        }
+    }
+
+    if (_pyramid_params.subpixel)
+    {
+        refineCorners(gray, out);
+    }
+    return out;
+}
+
+/**
+ * @brief 级联检测：第一级在降采样图上找高对比度的方形候选区域，解码器只在候选区域内运行
+ * @param gray 全帧灰度图
+ * @param roi 搜索区域（全帧坐标）
+ * @return 检测结果（全帧坐标），与 runDetector 相同
+ *
+ * 只在搜索阶段（没有跟踪窗口）启用：跟踪窗口本身已经很小，再做第一级得不偿失。
+ * 候选区域内沿用当前档位的检测参数，检测距离不因级联而缩短；第一级没有候选时跳过解码器，
+ * 并按 audit_interval 周期性地对被拒绝的帧做整幅检测，用于统计第一级的漏检率以便调参。
+ */
+std::vector<TagDetection> AprilTagTracker::runCascade(const cv::Mat &gray, const cv::Rect &roi)
+{
+    if (_track_valid)
+    {
+        return _pyramid_params.enabled ? runPyramid(gray, roi) : runDetector(gray, roi);
+    }
+
+    const float scale = std::max(1.0f, _cascade_params.scale);
+    cv::Mat coarse;
+    if (scale > 1.0f)
+    {
+        cv::resize(gray(roi), coarse, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+    }
+    else
+    {
+        coarse = gray(roi);
+    }
+    std::vector<cv::Rect> regions = findQuadCandidates(coarse, scale, _cascade_params.min_quad_side,
+                                                       _cascade_params.margin_ratio, _cascade_params.min_contrast);
+    _cascade_counters.frames.fetch_add(1, std::memory_order_relaxed);
+
+    if (regions.empty())
+    {
+        _cascade_counters.rejected.fetch_add(1, std::memory_order_relaxed);
+        if (_cascade_params.audit_interval > 0 && ++_cascade_rejected_run >= _cascade_params.audit_interval)
+        {
+            // 抽检：整幅检测，发现标签说明第一级漏检（结果照常使用）
+            _cascade_rejected_run = 0;
+            std::vector<TagDetection> out = runDetector(gray, roi);
+            _cascade_counters.audits.fetch_add(1, std::memory_order_relaxed);
+            if (!out.empty())
+            {
+                _cascade_counters.audit_misses.fetch_add(1, std::memory_order_relaxed);
+            }
+            return out;
+        }
+        return {};
+    }
+    _cascade_rejected_run = 0;
+
+    double region_area = 0.0;
+    for (cv::Rect &rect : regions)
+    {
+        rect.x += roi.x;
+        rect.y += roi.y;
+        rect &= roi;
+        region_area += rect.area();
+    }
+    if (static_cast<int>(regions.size()) > _cascade_params.max_regions || region_area > _cascade_params.max_area_ratio * roi.area())
+    {
+        _cascade_counters.fallbacks.fetch_add(1, std::memory_order_relaxed);
+        return runDetector(gray, roi);
+    }
+
+    std::vector<TagDetection> out;
+    for (const cv::Rect &rect : regions)
+    {
+        if (rect.width < 8 || rect.height < 8)
+        {
+            continue;
+        }
+        const std::vector<TagDetection> found = runDetector(gray, rect);
+        _cascade_counters.regions.fetch_add(1, std::memory_order_relaxed);
+        (found.empty() ? _cascade_counters.region_misses : _cascade_counters.region_hits).fetch_add(1, std::memory_order_relaxed);
+        out.insert(out.end(), found.begin(), found.end()); // 候选区域已合并为互不重叠，无需去重
+    }
+    return out;
+}
+
+/**
+ * @brief 在降采样图上查找候选四边形
+ * @param coarse 降采样后的搜索区域
+ * @param scale 降采样倍数
+ * @param min_side 降采样图上候选四边形的最小边长(像素)
+ * @param margin_ratio 候选区域外扩比例
+ * @param min_contrast 候选框内灰度标准差下限（0表示不检查）
+ * @return 候选区域（相对搜索区域左上角的全分辨率坐标，已外扩并合并重叠区域）
+ */
+std::vector<cv::Rect> AprilTagTracker::findQuadCandidates(const cv::Mat &coarse, float scale, int min_side,
+                                                          float margin_ratio, float min_contrast) const
+{
+    std::vector<cv::Rect> rects;
+    if (coarse.cols < 3 || coarse.rows < 3)
+    {
+        return rects;
+    }
+
+    // 局部自适应阈值：只保留比邻域暗的像素，标签黑色边框内侧形成闭合的四边形环
+    cv::Mat binary;
+    const int block = std::max(3, (std::min(coarse.cols, coarse.rows) / 16) | 1);
+    cv::adaptiveThreshold(coarse, binary, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY_INV, block, 5);
+
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(binary, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
+
+    std::vector<cv::Point> quad;
+    for (const std::vector<cv::Point> &contour : contours)
+    {
+        if (contour.size() < 4)
+        {
+            continue;
+        }
+        const double area = std::fabs(cv::contourArea(contour));
+        if (area < static_cast<double>(min_side) * min_side)
+        {
+            continue;
+        }
+        cv::approxPolyDP(contour, quad, 0.05 * cv::arcLength(contour, true), true);
+        if (quad.size() != 4 || !cv::isContourConvex(quad))
+        {
+            continue;
+        }
+
+        // 过滤过于细长的四边形（正常透视下标签不会超过4:1）
+        const cv::Rect box = cv::boundingRect(quad);
+        const int long_side = std::max(box.width, box.height);
+        const int short_side = std::min(box.width, box.height);
+        if (short_side < min_side || long_side > 4 * short_side)
+        {
+            continue;
+        }
+
+        // 对比度检查：标签内部黑白相间，阴影、色块等均匀区域的标准差很小
+        if (min_contrast > 0.0f)
+        {
+            cv::Scalar mean, stddev;
+            cv::meanStdDev(coarse(box), mean, stddev);
+            if (stddev[0] < min_contrast)
+            {
+                continue;
+            }
+        }
+
+        // 映射回全分辨率并外扩（降采样时角点最多偏移一个粗像素）
+        const float margin = std::max(margin_ratio * long_side, 2.0f) * scale;
+        rects.emplace_back(static_cast<int>(std::floor(box.x * scale - margin)),
+                           static_cast<int>(std::floor(box.y * scale - margin)),
+                           static_cast<int>(std::ceil(box.width * scale + 2.0f * margin)),
+                           static_cast<int>(std::ceil(box.height * scale + 2.0f * margin)));
+    }
+
+    // 合并重叠区域：标签内部的数据位也会形成小四边形，合并后每个标签只解码一次
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < rects.size() && !merged; ++i)
+        {
+            for (size_t j = i + 1; j < rects.size(); ++j)
+            {
+                if ((rects[i] & rects[j]).area() > 0)
+                {
+                    rects[i] |= rects[j];
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+    return rects;
+}
+
+/**
+ * @brief 亚像素角点细化
+ * @param gray 全帧灰度图（检测器未修改过的原始图像）
+ * @param detections 检测结果，角点和中心原地更新
+ *
+ * 搜索窗口随标签边长缩放；细化后角点偏移超过窗口时认为收敛到了其他角点，保留原值。
+ * 中心取两条对角线的交点，与AprilTag库的中心定义一致。
+ */
+void AprilTagTracker::refineCorners(const cv::Mat &gray, std::vector<TagDetection> &detections) const
+{
+    const cv::TermCriteria criteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.01);
+    std::vector<cv::Point2f> corners(4);
+
+    for (TagDetection &det : detections)
+    {
+        float side = std::numeric_limits<float>::max();
+        for (int k = 0; k < 4; ++k)
+        {
+            const cv::Point2f d = det.corners[(k + 1) % 4] - det.corners[k];
+            side = std::min(side, std::sqrt(d.x * d.x + d.y * d.y));
+            corners[k] = det.corners[k];
+        }
+        if (side < 12.0f)
+        {
+            continue; // 标签太小，窗口会覆盖相邻角点
+        }
+        const int win = std::min(5, std::max(2, static_cast<int>(side / 10.0f)));
+
+        bool inside = true;
+        for (const cv::Point2f &c : corners)
+        {
+            inside = inside && c.x >= win + 1 && c.y >= win + 1 && c.x < gray.cols - win - 1 && c.y < gray.rows - win - 1;
+        }
+        if (!inside)
+        {
+            continue;
+        }
+
+        cv::cornerSubPix(gray, corners, cv::Size(win, win), cv::Size(-1, -1), criteria);
+        for (int k = 0; k < 4; ++k)
+        {
+            const cv::Point2f d = corners[k] - det.corners[k];
+            if (std::fabs(d.x) <= win && std::fabs(d.y) <= win)
+            {
+                det.corners[k] = corners[k];
+            }
+        }
+
+        // 对角线 p0-p2 与 p1-p3 的交点
+        const cv::Point2f a = det.corners[2] - det.corners[0];
+        const cv::Point2f b = det.corners[3] - det.corners[1];
+        const float denom = a.x * b.y - a.y * b.x;
+        if (std::fabs(denom) > 1e-6f)
+        {
+            const cv::Point2f w = det.corners[1] - det.corners[0];
+            const float t = (w.x * b.y - w.y * b.x) / denom;
+            det.center = det.corners[0] + a * t;
+        }
+    }
+}
+
+/**
+ * @brief 判断能否直接在Mat数据上构造AprilTag图像视图
+ * @param region 待检测的灰度图区域
+ * @return 数据地址和行步长均满足对齐要求，且检测器不会原地修改输入图像时返回true
+ *
+ * AprilTag在不降采样(quad_decimate <= 1)且模糊核大于1时会对输入图像原地做高斯模糊，
+ * 此时直接使用视图会破坏相机帧（它可能同时被显示或录像使用），必须复制。
+ */
+bool AprilTagTracker::canViewDirectly(const cv::Mat &region) const
+{
+    const bool aligned = reinterpret_cast<uintptr_t>(region.data) % DETECTION_ALIGNMENT == 0 &&
+                         region.step % DETECTION_ALIGNMENT == 0;
+    if (!aligned)
+    {
+        return false;
+    }
+
+    // 与AprilTag库中的模糊核尺寸计算保持一致
+    int ksz = static_cast<int>(4 * std::fabs(td->quad_sigma));
+    if ((ksz & 1) == 0)
+    {
+        ksz++;
+    }
+    const bool blurs_in_place = td->quad_decimate <= 1.0f && td->quad_sigma != 0.0f && ksz > 1;
+    return !blurs_in_place;
+}
+
+/**
+ * @brief 获取常驻检测缓冲区（行步长对齐），容量不足时才重新分配
+ * @param width 图像宽度
+ * @param height 图像高度
+ * @return 指向常驻缓冲区的AprilTag图像头
+ */
+image_u8_t AprilTagTracker::prepareDetectionBuffer(int width, int height)
+{
+    const size_t stride = (static_cast<size_t>(width) + DETECTION_ALIGNMENT - 1) / DETECTION_ALIGNMENT * DETECTION_ALIGNMENT;
+    const size_t bytes = stride * static_cast<size_t>(height);
+
+    if (bytes > _det_capacity)
+    {
+        _det_storage.reset(static_cast<uint8_t *>(std::aligned_alloc(DETECTION_ALIGNMENT, bytes)));
+        if (!_det_storage)
+        {
+            _det_capacity = 0;
+            std::cerr << "无法分配图像_u8 缓冲区" << std::endl;
+            throw std::bad_alloc(); // 内存分配失败异常
+        }
+        _det_capacity = bytes;
+    }
+
+    // image_u8_t 的尺寸字段为常量，每次按本帧尺寸构造图像头，缓冲区本身常驻复用
+    return image_u8_t{width, height, static_cast<int32_t>(stride), _det_storage.get()};
+}
+
+/**
+ * @brief 根据本帧检测结果更新区域跟踪状态
+ * @param found 本帧是否找到有效标签
+ * @param center 标签中心（全帧坐标）
+ * @param area 标签像素面积
+ */
+void AprilTagTracker::updateTrack(bool found, const cv::Point2f &center, float area)
+{
+    if (!_roi_params.enabled)
+    {
+        return;
+    }
+
+    if (found)
+    {
+        // 速度按帧计，做简单平滑以抑制角点抖动
+        const cv::Point2f velocity = _track_valid ? center - _track_center : cv::Point2f(0.0f, 0.0f);
+        _track_velocity = _track_valid ? 0.5f * _track_velocity + 0.5f * velocity : velocity;
+        _track_center = center;
+        _track_size = std::sqrt(area);
+        _track_valid = true;
+        _track_misses = 0;
+    }
+    else if (_track_valid && ++_track_misses >= _roi_params.max_misses)
+    {
+        // 连续多帧在窗口内未找到标签，回到全图搜索
+        resetTrack();
+    }
+}
+
+/**
+ * @brief 主检测函数：从相机帧中检测AprilTag标签并计算其位置
+ * @param frame 输入相机帧（优先使用其中的灰度图）
+ * @param drawOverlay 是否绘制检测结果叠加层（仅此时才生成BGR图）
+ * @return 包含检测结果的AprilTagData结构体
+ */
+AprilTagData AprilTagTracker::detect(const CameraFrame &frame, bool drawOverlay)
+{
+    const int64_t detect_start_ns = steadyNowNs();
+
     // 初始化返回结果（默认未检测到标签）
     AprilTagData result = {
         false,
@@ -162,73 +1217,94 @@ AprilTagData AprilTagTracker::detect(cv::Mat &frame, bool drawOverlay)
         }
 
         // 记录图像尺寸到结果结构体
-        result.width = frame.cols;
-        result.height = frame.rows;
+        result.width = frame.width();
+        result.height = frame.height();
 
         // ------------------- 图像预处理阶段 -------------------
-        cv::Mat gray, binary;
-        if (frame.channels() == 3)
-        {
-            // BGR彩色图转灰度图（AprilTag检测仅需灰度信息）
-            cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-        }
-        else
-        {
-            // 已为灰度图时直接复用
-            gray = frame;
-        }
-        binary = gray; // 直接使用灰度图进行二值化处理
+        // 相机已提供灰度图时直接复用，否则由彩色图转换（AprilTag检测仅需灰度信息）
+        cv::Mat gray = frame.grayOrConvert();
+        cv::Mat binary = gray; // 直接使用灰度图进行二值化处理
 
-        // 分配AprilTag库所需的图像缓冲区
-        image_u8_t *im = image_u8_create(binary.cols, binary.rows);
-        if (!im)
+        // ------------------- 变化门控阶段 -------------------
+        // 悬停时相邻帧几乎相同：画面相对上一次完整检测没有明显变化时复用其结果，跳过整个检测流程
+        // （参考图尺寸不同时门控必定判为变化；上一帧检测异常时没有可复用的结果）
+        if (_change_gate.unchanged(gray) && _frame_result_valid)
         {
-            std::cerr << "无法分配图像_u8 缓冲区" << std::endl;
-            throw std::bad_alloc(); // 内存分配失败异常
-        }
+            result = _frame_result;
+            result.reused = true;
 
-        // 将OpenCV图像数据复制到AprilTag缓冲区
-        for (int y = 0; y < binary.rows; ++y)
-        {
-            memcpy(im->buf + y * im->stride,
-                   binary.data + y * binary.step,
-                   binary.cols);
+            const int64_t detect_end_ns = steadyNowNs();
+            stampResult(result, frame, detect_start_ns, detect_end_ns);
+            pipeline_latency::Instance()->recordDetection(frame.capture_ns, detect_start_ns, detect_end_ns);
+            frame_recorder::Instance()->recordDetections(frame.sequence, detect_end_ns, _frame_detections); // 与上一帧相同
+            _reused_frames.fetch_add(1, std::memory_order_relaxed);
+
+            if (result.iffind)
+            {
+                // 画面静止说明标签位置未变，作为本帧的观测融合（保持滤波器时间推进、速度收敛到零）
+                {
+                    std::lock_guard<std::mutex> lock(filter_mutex_);
+                    _tag_filter.update(result.x, result.y, frame.capture_ns > 0 ? frame.capture_ns : detect_start_ns);
+                }
+                std::lock_guard<std::mutex> lock(data_mutex_);
+                _last_results = result;
+            }
+            return result;
         }
+        _frame_detections.clear();
+        _frame_result_valid = false;
 
         // ------------------- AprilTag检测阶段 -------------------
-        // 执行标签检测算法
-        zarray_t *detections = apriltag_detector_detect(td, im); // 调用AprilTag库检测函数
-
-        // 检测结果数量分类处理
-        if (zarray_size(detections) > 1)
+        // 根据高度和上一次标签面积选择检测器档位，档位变化时才修改检测器参数
+        // 检测持续超出帧时间预算时，调节器在档位基础上进一步提高降采样倍数
+        DetectorProfile profile = _profile_scheduler.select(_relative_altitude, _last_results.iffind ? _last_results.size : 0.0f);
+        const float governor_scale = _governor.decimateScale();
+        if (governor_scale > 1.0f)
         {
-            // 检测到多个标签时重置计时
-            _start = clock();
-            detect_twotag = true; // 标记多标签检测状态
+            profile.quad_decimate = std::max(profile.quad_decimate, 1.0f) * governor_scale;
         }
-        else if (zarray_size(detections) > 0 && !detect_twotag)
+        if (profile.name != _active_profile.name || profile.quad_decimate != _active_profile.quad_decimate)
         {
-            // 检测到单个标签且非多标签模式时重置计时
-            _start = clock();
+            applyProfile(profile);
         }
-        else
+
+        // 两次完整检测之间先尝试光流跟踪上一帧的角点，失败时本帧立即完整检测
+        std::vector<TagDetection> detections;
+        float confidence = 1.0f;
+        const bool tracked = trackFlow(gray, detections, confidence);
+        if (!tracked)
         {
-            // 未检测到标签时的超时处理
-            if ((double)(clock() - _start) / CLOCKS_PER_SEC > 3)
+            // 跟踪有效时只在上一次检测位置附近的窗口内搜索
+            const cv::Rect roi = searchWindow(binary.size());
+            if (_tiled)
+            {
+                detections = _tiled->detect(binary, roi, _active_profile);
+            }
+            else if (_cascade_params.enabled)
             {
-                // 超过3秒未检测到标签，重置状态
-                detect_twotag = false;
-                result.iffind = false;
+                detections = runCascade(binary, roi);
             }
             else
             {
-                // 短时间未检测到时返回上一次结果
-                result = _last_results;
+                detections = _pyramid_params.enabled ? runPyramid(binary, roi) : runDetector(binary, roi);
             }
+        }
+
+        // 未检测到标签：单个还是多个标签不影响本帧是否有效，由着陆板选择决定
+        if (detections.empty())
+        {
+            updateTrack(false, cv::Point2f(), 0.0f);
+            _flow_valid = false;
+
+            const int64_t detect_end_ns = steadyNowNs();
+            pipeline_latency::Instance()->recordDetection(frame.capture_ns, detect_start_ns, detect_end_ns);
+            frame_recorder::Instance()->recordDetections(frame.sequence, detect_end_ns, _frame_detections); // 录像中记录本帧未检测到
 
-            // 释放检测资源
-            apriltag_detections_destroy(detections);
-            image_u8_destroy(im);
+            // 本帧结果如实返回未检测到；短时丢失由 process() / predictTag() 按卡尔曼预测外推
+            result.iffind = false;
+            stampResult(result, frame, detect_start_ns, detect_end_ns);
+            _frame_result = result;
+            _frame_result_valid = true;
             return result;
         }
 
@@ -236,17 +1312,14 @@ AprilTagData AprilTagTracker::detect(cv::Mat &frame, bool drawOverlay)
         _areas.clear();
 
         // ------------------- 检测结果遍历处理 -------------------
-        for (int i = 0; i < zarray_size(detections); ++i)
+        for (const TagDetection &det : detections)
         {
-            apriltag_detection_t *det;
-            zarray_get(detections, i, &det); // 提取单个检测结果
-
             // 提取标签四边形四个顶点坐标（按顺时针顺序）
             const cv::Point2f points[4] = {
-                {static_cast<float>(det->p[3][0]), static_cast<float>(det->p[3][1])}, // 左上顶点
-                {static_cast<float>(det->p[0][0]), static_cast<float>(det->p[0][1])}, // 右上顶点
-                {static_cast<float>(det->p[1][0]), static_cast<float>(det->p[1][1])}, // 右下顶点
-                {static_cast<float>(det->p[2][0]), static_cast<float>(det->p[2][1])}  // 左下顶点
+                det.corners[3], // 左上顶点
+                det.corners[0], // 右上顶点
+                det.corners[1], // 右下顶点
+                det.corners[2]  // 左下顶点
             };
 
             // 几何验证：检查四边形形状合法性和面积阈值（添加完整4个参数）
@@ -256,34 +1329,29 @@ AprilTagData AprilTagTracker::detect(cv::Mat &frame, bool drawOverlay)
             }
 
             // 提取标签中心坐标
-            result.x = det->c[0]; // 列坐标 -> x
-            result.y = det->c[1]; // 行坐标 -> y
+            result.x = det.center.x; // 列坐标 -> x
+            result.y = det.center.y; // 行坐标 -> y
+            result.id = det.id;
             result.iffind = true; // 标记找到标签
 
             // 计算与图像中心的偏差
-            result.err_x = (result.height / 2.0) - result.y; // X方向偏差
-            result.err_y = (result.width / 2.0) - result.x;  // Y方向偏差
-
-            // 相对于图像全宽 / 全高归一化（结果范围 [-0.5, 0.5]）：
-            result.norm_err_x = result.err_x / result.width;
-            result.norm_err_y = result.err_y / result.height;
+            computeErrors(result);
 
             // 计算标签面积并记录
-            _areas.push_back(calculateQuadrilateralArea(points));
+            result.size = calculateQuadrilateralArea(points);
+            _areas.push_back(result.size);
+            _frame_detections.push_back(det);
 
             // ------------------- 可视化绘制阶段 -------------------
-            apriltag_detection_t *best_det = nullptr; // 最佳检测结果指针
-            cv::Mat display;                          // 可视化输出图像
+            cv::Mat display; // 可视化输出图像
             if (drawOverlay)
             {
-                display = frame.clone(); // 需要绘制时复制原图
+                display = frame.bgr(); // 需要绘制时才生成彩色图
 
                 // 绘制标签四边形边界
                 for (int i = 0; i < 4; i++)
                 {
-                    cv::Point pt1(best_det->p[i][0], best_det->p[i][1]);
-                    cv::Point pt2(best_det->p[(i + 1) % 4][0], best_det->p[(i + 1) % 4][1]);
-                    cv::line(display, pt1, pt2, cv::Scalar(0, 255, 0), 2); // 绿色边界线
+                    cv::line(display, det.corners[i], det.corners[(i + 1) % 4], cv::Scalar(0, 255, 0), 2); // 绿色边界线
                 }
 
                 // 绘制标签中心点（红色圆点）
@@ -291,22 +1359,76 @@ AprilTagData AprilTagTracker::detect(cv::Mat &frame, bool drawOverlay)
             }
         }
 
-        // ------------------- 多目标逻辑处理 -------------------
-        if (_areas.size() > 1)
+        // ------------------- 着陆板标签选择 -------------------
+        // 在所有通过验证的标签中选出条件最好的一个（而不是循环中最后一个），换算为着陆板中心
+        // 选择和区域跟踪使用原始图像坐标；偏差和位姿只对所选标签的角点和中心查表去畸变（未加载标定时不变）
+        const PadEstimate pad = _pad.select(_frame_detections, binary.size());
+        result.tracked = tracked; // 跟踪结果未通过验证时也标记，检测线程据此不把本帧计入检测耗时
+        if (pad.valid)
+        {
+            _calibration.prepare(binary.size());
+            const TagDetection geometry = _calibration.undistort(_frame_detections[pad.index]);
+            const cv::Point2f center = _pad.center(geometry);
+            result.x = center.x;
+            result.y = center.y;
+            result.id = pad.id;
+            result.size = _areas[pad.index]; // 档位调度按所选标签的像素面积判断是否需要更精细的档位
+            result.confidence = confidence;
+            computeErrors(result);
+            estimatePose(result, geometry, binary.size());
+        }
+        else
+        {
+            result.iffind = false; // 只看到不属于着陆板的标签
+        }
+
+        // 更新区域跟踪状态（所有候选都未通过几何验证时记为一次丢失）
+        // 窗口跟随所选标签本身的中心（窗口大小按该标签边长计算），而不是板中心：偏离板中心的小标签也能完整落在窗口内
+        updateTrack(result.iffind, pad.valid ? _frame_detections[pad.index].center : cv::Point2f(result.x, result.y), result.size);
+
+        // 更新光流参考：所选标签的角点作为下一帧的跟踪起点
+        if (_flow_params.enabled)
         {
+            _flow_valid = pad.valid;
+            if (pad.valid)
+            {
+                gray.copyTo(_flow_prev);
+                _flow_tag = _frame_detections[pad.index];
+                _flow_confidence = confidence;
+                _flow_run = tracked ? _flow_run + 1 : 0;
+            }
         }
-        else if (_areas.size() > 0)
+        if (tracked)
         {
-            // 单目标时重置多目标标记
-            detect_twotag = false;
+            _tracked_frames.fetch_add(1, std::memory_order_relaxed);
         }
 
-        // 保存检测结果
-        _last_results = result;
+        const int64_t detect_end_ns = steadyNowNs();
+        stampResult(result, frame, detect_start_ns, detect_end_ns);
+        pipeline_latency::Instance()->recordDetection(frame.capture_ns, detect_start_ns, detect_end_ns);
+        frame_recorder::Instance()->recordDetections(frame.sequence, detect_end_ns, _frame_detections);
+        _frame_result = result;
+        _frame_result_valid = true;
 
-        // 释放检测资源（必须在函数结束前执行）
-        apriltag_detections_destroy(detections);
-        image_u8_destroy(im);
+        if (result.iffind)
+        {
+            // 以图像采集时刻融合到标签状态滤波器（无采集时间戳时用检测开始时刻）
+            {
+                std::lock_guard<std::mutex> lock(filter_mutex_);
+                // 着陆板模式下各标签都换算到同一个板中心，切换标签不重置滤波器
+                const int filter_id = _pad.empty() ? result.id : LandingPad::PAD_ID;
+                if (filter_id != _filter_id)
+                {
+                    _tag_filter.reset(); // 换了标签，重新初始化
+                    _filter_id = filter_id;
+                }
+                _tag_filter.update(result.x, result.y, frame.capture_ns > 0 ? frame.capture_ns : detect_start_ns);
+            }
+
+            // 保存检测结果（控制线程在 process() 中读取）
+            std::lock_guard<std::mutex> lock(data_mutex_);
+            _last_results = result;
+        }
     }
     // ------------------- 异常处理阶段 -------------------
     catch (const cv::Exception &e)
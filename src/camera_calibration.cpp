@@ -0,0 +1,205 @@
+#include "camera_calibration.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+/**
+ * @brief 从文件加载标定结果
+ * @param path 标定文件路径
+ * @return 加载成功返回true
+ */
+bool CameraCalibration::load(const std::string &path)
+{
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened())
+    {
+        std::cerr << "无法打开相机标定文件: " << path << std::endl;
+        return false;
+    }
+
+    cv::Mat camera_matrix;
+    cv::Mat dist_coeffs;
+    fs["camera_matrix"] >> camera_matrix;
+    fs["distortion_coefficients"] >> dist_coeffs;
+    const cv::Size image_size(static_cast<int>(fs["image_width"]), static_cast<int>(fs["image_height"]));
+
+    if (camera_matrix.rows != 3 || camera_matrix.cols != 3)
+    {
+        std::cerr << "相机标定文件缺少 3x3 的 camera_matrix: " << path << std::endl;
+        return false;
+    }
+    camera_matrix.convertTo(camera_matrix, CV_64F);
+    if (!set(cv::Matx33d(camera_matrix.ptr<double>()), dist_coeffs, image_size))
+    {
+        std::cerr << "相机标定文件参数无效: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 设置标定结果（清除已生成的查找表）
+ */
+bool CameraCalibration::set(const cv::Matx33d &camera_matrix, const cv::Mat &dist_coeffs, const cv::Size &image_size)
+{
+    const size_t coeffs = dist_coeffs.total();
+    const bool coeffs_valid = coeffs == 0 || coeffs == 4 || coeffs == 5 || coeffs == 8 || coeffs == 12 || coeffs == 14;
+    if (image_size.width <= 0 || image_size.height <= 0 || camera_matrix(0, 0) <= 0.0 || camera_matrix(1, 1) <= 0.0 || !coeffs_valid)
+    {
+        return false;
+    }
+
+    camera_matrix_ = camera_matrix;
+    dist_coeffs_ = dist_coeffs.empty() ? cv::Mat() : dist_coeffs.reshape(1, 1).clone();
+    if (!dist_coeffs_.empty())
+    {
+        dist_coeffs_.convertTo(dist_coeffs_, CV_64F);
+    }
+    calib_size_ = image_size;
+
+    frame_size_ = cv::Size();
+    intrinsics_ = CameraIntrinsics();
+    lut_.release();
+    remap_map1_.release();
+    remap_map2_.release();
+    return true;
+}
+
+CameraIntrinsics CameraCalibration::intrinsicsFor(const cv::Size &frame_size) const
+{
+    CameraIntrinsics intrinsics;
+    if (!loaded() || frame_size.width <= 0 || frame_size.height <= 0)
+    {
+        return intrinsics;
+    }
+    const double sx = static_cast<double>(frame_size.width) / calib_size_.width;
+    const double sy = static_cast<double>(frame_size.height) / calib_size_.height;
+    intrinsics.fx = camera_matrix_(0, 0) * sx;
+    intrinsics.fy = camera_matrix_(1, 1) * sy;
+    intrinsics.cx = camera_matrix_(0, 2) * sx;
+    intrinsics.cy = camera_matrix_(1, 2) * sy;
+    return intrinsics;
+}
+
+/**
+ * @brief 为指定帧尺寸准备查找表
+ * @param frame_size 帧尺寸
+ * @return 查找表可用返回true
+ *
+ * 对帧内全部像素调用一次 cv::undistortPoints（迭代求解畸变模型的逆），640x480 约需数十毫秒，只在首帧或尺寸变化时执行。
+ */
+bool CameraCalibration::prepare(const cv::Size &frame_size)
+{
+    if (!loaded() || frame_size.width < 2 || frame_size.height < 2)
+    {
+        return false;
+    }
+    if (frame_size == frame_size_ && ready())
+    {
+        return true;
+    }
+
+    // 按分辨率缩放内参
+    const double sx = static_cast<double>(frame_size.width) / calib_size_.width;
+    intrinsics_ = intrinsicsFor(frame_size);
+    frame_matrix_ = cv::Matx33d(intrinsics_.fx, camera_matrix_(0, 1) * sx, intrinsics_.cx,
+                                0.0, intrinsics_.fy, intrinsics_.cy,
+                                0.0, 0.0, 1.0);
+
+    std::vector<cv::Point2f> pixels;
+    pixels.reserve(static_cast<size_t>(frame_size.area()));
+    for (int y = 0; y < frame_size.height; ++y)
+    {
+        for (int x = 0; x < frame_size.width; ++x)
+        {
+            pixels.emplace_back(static_cast<float>(x), static_cast<float>(y));
+        }
+    }
+
+    std::vector<cv::Point2f> undistorted;
+    if (dist_coeffs_.empty())
+    {
+        undistorted = pixels; // 无畸变：查找表为恒等映射
+    }
+    else
+    {
+        // 输出仍用同一内参投影回像素坐标，位姿解算时不需要再处理畸变
+        cv::undistortPoints(pixels, undistorted, frame_matrix_, dist_coeffs_, cv::noArray(), frame_matrix_);
+    }
+
+    lut_ = cv::Mat(undistorted, true).reshape(2, frame_size.height);
+    frame_size_ = frame_size;
+    remap_map1_.release();
+    remap_map2_.release();
+    return true;
+}
+
+/**
+ * @brief 单点去畸变
+ * @param point 原始图像坐标
+ * @return 去畸变后的坐标
+ *
+ * 在查找表中双线性插值；超出图像的点按最近边缘像素的位移平移（角点细化后可能略微出画）。
+ */
+cv::Point2f CameraCalibration::undistortPoint(const cv::Point2f &point) const
+{
+    if (!ready())
+    {
+        return point;
+    }
+
+    const float x = std::min(std::max(point.x, 0.0f), static_cast<float>(frame_size_.width - 1));
+    const float y = std::min(std::max(point.y, 0.0f), static_cast<float>(frame_size_.height - 1));
+    const int x0 = std::min(static_cast<int>(x), frame_size_.width - 2);
+    const int y0 = std::min(static_cast<int>(y), frame_size_.height - 2);
+    const float ax = x - x0;
+    const float ay = y - y0;
+
+    const cv::Vec2f *row0 = lut_.ptr<cv::Vec2f>(y0);
+    const cv::Vec2f *row1 = lut_.ptr<cv::Vec2f>(y0 + 1);
+    const auto lerp = [ax, ay, row0, row1, x0](int c)
+    {
+        const float top = row0[x0][c] + (row0[x0 + 1][c] - row0[x0][c]) * ax;
+        const float bottom = row1[x0][c] + (row1[x0 + 1][c] - row1[x0][c]) * ax;
+        return top + (bottom - top) * ay;
+    };
+    return cv::Point2f(lerp(0) + (point.x - x), lerp(1) + (point.y - y));
+}
+
+/**
+ * @brief 对检测结果的角点和中心去畸变
+ * @param det 原始检测结果
+ * @return 去畸变后的副本（查找表未准备时原样返回）
+ */
+TagDetection CameraCalibration::undistort(const TagDetection &det) const
+{
+    TagDetection result = det;
+    if (!ready())
+    {
+        return result;
+    }
+    for (int k = 0; k < 4; ++k)
+    {
+        result.corners[k] = undistortPoint(det.corners[k]);
+    }
+    result.center = undistortPoint(det.center);
+    return result;
+}
+
+/**
+ * @brief 整帧去畸变（调试用）
+ */
+bool CameraCalibration::remap(const cv::Mat &src, cv::Mat &dst)
+{
+    if (!ready() || src.size() != frame_size_)
+    {
+        return false;
+    }
+    if (remap_map1_.empty())
+    {
+        cv::initUndistortRectifyMap(frame_matrix_, dist_coeffs_, cv::noArray(), frame_matrix_, frame_size_, CV_16SC2, remap_map1_, remap_map2_);
+    }
+    cv::remap(src, dst, remap_map1_, remap_map2_, cv::INTER_LINEAR);
+    return true;
+}
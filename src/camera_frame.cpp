@@ -0,0 +1,50 @@
+#include "camera_frame.hpp"
+#include "color_convert.hpp"
+
+/**
+ * @brief 按需生成 BGR 彩色图
+ * @return BGR 格式的新图像；帧为空时返回空图
+ */
+cv::Mat CameraFrame::bgr() const
+{
+    cv::Mat out;
+    switch (color_format)
+    {
+        case FramePixelFormat::RGB8:
+            cv::cvtColor(color, out, cv::COLOR_RGB2BGR);
+            break;
+        case FramePixelFormat::BGR8:
+            out = color.clone();
+            break;
+        default:
+            if (!gray.empty())
+            {
+                cv::cvtColor(gray, out, cv::COLOR_GRAY2BGR);
+            }
+            break;
+    }
+    return out;
+}
+
+/**
+ * @brief 获取灰度图
+ * @return 已有灰度图时直接返回（不复制），否则由彩色图转换得到
+ */
+cv::Mat CameraFrame::grayOrConvert() const
+{
+    if (!gray.empty())
+    {
+        return gray;
+    }
+
+    cv::Mat out;
+    if (color_format == FramePixelFormat::RGB8)
+    {
+        ColorConvert::toGray(color, out, ColorConvert::ChannelOrder::RGB);
+    }
+    else if (color_format == FramePixelFormat::BGR8)
+    {
+        ColorConvert::toGray(color, out, ColorConvert::ChannelOrder::BGR);
+    }
+    return out;
+}
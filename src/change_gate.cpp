@@ -0,0 +1,53 @@
+#include "change_gate.hpp"
+
+#include <algorithm>
+
+// 设置参数
+void ChangeGate::setParams(const ChangeGateParams &params)
+{
+    params_ = params;
+    params_.block_px = std::max(1, params_.block_px);
+    reset();
+}
+
+// 清除参考图
+void ChangeGate::reset()
+{
+    reference_.release();
+    reuse_count_ = 0;
+}
+
+bool ChangeGate::unchanged(const cv::Mat &gray)
+{
+    if (!params_.enabled || gray.empty())
+    {
+        return false;
+    }
+    checked_++;
+
+    // 面积平均降采样：每格是原图 block_px x block_px 区域的均值，传感器噪声被大幅平均掉
+    const cv::Size thumb_size(std::max(1, gray.cols / params_.block_px), std::max(1, gray.rows / params_.block_px));
+    cv::resize(gray, thumb_, thumb_size, 0, 0, cv::INTER_AREA);
+
+    bool similar = false;
+    if (!reference_.empty() && reference_.size() == thumb_.size() && reuse_count_ < params_.max_reuse_frames)
+    {
+        cv::absdiff(thumb_, reference_, diff_);
+        double max_diff = 0.0;
+        cv::minMaxLoc(diff_, nullptr, &max_diff);
+        last_mean_diff_ = static_cast<float>(cv::mean(diff_)[0]);
+        similar = last_mean_diff_ < params_.mean_threshold && max_diff < params_.block_threshold;
+    }
+
+    if (similar)
+    {
+        reuse_count_++;
+        reused_++;
+        return true;
+    }
+
+    // 需要重新检测：本帧成为新的参考图
+    thumb_.copyTo(reference_);
+    reuse_count_ = 0;
+    return false;
+}
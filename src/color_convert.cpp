@@ -0,0 +1,507 @@
+#include "color_convert.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLOR_CONVERT_X86 1
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define COLOR_CONVERT_NEON 1
+#endif
+
+namespace ColorConvert
+{
+    namespace
+    {
+        constexpr int SHIFT = 14;               // 定点位数
+        constexpr int ROUND = 1 << (SHIFT - 1); // 四舍五入偏置
+        constexpr int R2Y = 4899;               // 0.299 * 2^14
+        constexpr int G2Y = 9617;               // 0.587 * 2^14
+        constexpr int B2Y = 1868;               // 0.114 * 2^14
+
+        // 按内存中通道顺序排列的系数
+        struct Coeffs
+        {
+            int k0, k1, k2;
+        };
+
+        Coeffs coeffsFor(ChannelOrder order)
+        {
+            return order == ChannelOrder::RGB ? Coeffs{R2Y, G2Y, B2Y} : Coeffs{B2Y, G2Y, R2Y};
+        }
+
+        // 单行三通道转灰度
+        using RowKernel = void (*)(const uint8_t *src, uint8_t *dst, int width, const Coeffs &k);
+        // 两行灰度 2x2 均值降采样（输出 width/2 个像素）
+        using HalfKernel = void (*)(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int out_width);
+
+        /*::::::::::::::::::::::::::::::::::::::::::::::::::::::: 标量实现 :::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
+        inline uint8_t grayPixel(const uint8_t *p, const Coeffs &k)
+        {
+            return static_cast<uint8_t>((p[0] * k.k0 + p[1] * k.k1 + p[2] * k.k2 + ROUND) >> SHIFT);
+        }
+
+        void rowScalar(const uint8_t *src, uint8_t *dst, int width, const Coeffs &k)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                dst[x] = grayPixel(src + 3 * x, k);
+            }
+        }
+
+        void halfScalar(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int out_width)
+        {
+            for (int x = 0; x < out_width; ++x)
+            {
+                const int sum = row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1];
+                dst[x] = static_cast<uint8_t>((sum + 2) >> 2);
+            }
+        }
+
+#if defined(COLOR_CONVERT_X86)
+        /*::::::::::::::::::::::::::::::::::::::::::::::::::::::: x86 实现 :::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
+        // 16 像素 48 字节的解交织掩码：masks[c][j] 从第 j 个 16 字节块中取出通道 c 的字节
+        struct ShuffleMasks
+        {
+            __m128i m[3][3];
+        };
+
+        const ShuffleMasks &shuffleMasks()
+        {
+            static const ShuffleMasks masks = []
+            {
+                ShuffleMasks result;
+                for (int c = 0; c < 3; ++c)
+                {
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        alignas(16) int8_t idx[16];
+                        for (int i = 0; i < 16; ++i)
+                        {
+                            const int byte = 3 * i + c;
+                            idx[i] = (byte / 16 == j) ? static_cast<int8_t>(byte % 16) : static_cast<int8_t>(-1);
+                        }
+                        result.m[c][j] = _mm_load_si128(reinterpret_cast<const __m128i *>(idx));
+                    }
+                }
+                return result;
+            }();
+            return masks;
+        }
+
+        // 将 16 个三通道像素解交织为三个通道向量
+        __attribute__((target("sse4.1"))) inline void deinterleave16(const uint8_t *src, const ShuffleMasks &m,
+                                                                       __m128i &c0, __m128i &c1, __m128i &c2)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+            c0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m.m[0][0]), _mm_shuffle_epi8(b, m.m[0][1])), _mm_shuffle_epi8(c, m.m[0][2]));
+            c1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m.m[1][0]), _mm_shuffle_epi8(b, m.m[1][1])), _mm_shuffle_epi8(c, m.m[1][2]));
+            c2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m.m[2][0]), _mm_shuffle_epi8(b, m.m[2][1])), _mm_shuffle_epi8(c, m.m[2][2]));
+        }
+
+        // 8 个 16 位像素的加权和：(c0,c1) 与 (k0,k1) 成对相乘，(c2,1) 与 (k2,ROUND) 成对相乘
+        __attribute__((target("sse4.1"))) inline __m128i weigh8(__m128i c0, __m128i c1, __m128i c2, __m128i k01, __m128i k2r)
+        {
+            const __m128i one = _mm_set1_epi16(1);
+            const __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(c0, c1), k01),
+                                             _mm_madd_epi16(_mm_unpacklo_epi16(c2, one), k2r));
+            const __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(c0, c1), k01),
+                                             _mm_madd_epi16(_mm_unpackhi_epi16(c2, one), k2r));
+            return _mm_packs_epi32(_mm_srli_epi32(lo, SHIFT), _mm_srli_epi32(hi, SHIFT));
+        }
+
+        __attribute__((target("sse4.1"))) void rowSse41(const uint8_t *src, uint8_t *dst, int width, const Coeffs &k)
+        {
+            const ShuffleMasks &m = shuffleMasks();
+            const __m128i k01 = _mm_set1_epi32((k.k1 << 16) | k.k0);
+            const __m128i k2r = _mm_set1_epi32((ROUND << 16) | k.k2);
+            const __m128i zero = _mm_setzero_si128();
+
+            int x = 0;
+            for (; x + 16 <= width; x += 16)
+            {
+                __m128i c0, c1, c2;
+                deinterleave16(src + 3 * x, m, c0, c1, c2);
+
+                const __m128i lo = weigh8(_mm_cvtepu8_epi16(c0), _mm_cvtepu8_epi16(c1), _mm_cvtepu8_epi16(c2), k01, k2r);
+                const __m128i hi = weigh8(_mm_unpackhi_epi8(c0, zero), _mm_unpackhi_epi8(c1, zero), _mm_unpackhi_epi8(c2, zero), k01, k2r);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(lo, hi));
+            }
+            rowScalar(src + 3 * x, dst + x, width - x, k);
+        }
+
+        __attribute__((target("sse4.1"))) void halfSse41(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int out_width)
+        {
+            const __m128i ones = _mm_set1_epi8(1);
+            const __m128i two = _mm_set1_epi16(2);
+
+            int x = 0;
+            for (; x + 16 <= out_width; x += 16)
+            {
+                // maddubs 对相邻两个无符号字节求和，得到水平方向的两像素和
+                __m128i s0 = _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * x)), ones),
+                                           _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * x)), ones));
+                __m128i s1 = _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * x + 16)), ones),
+                                           _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * x + 16)), ones));
+                s0 = _mm_srli_epi16(_mm_add_epi16(s0, two), 2);
+                s1 = _mm_srli_epi16(_mm_add_epi16(s1, two), 2);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(s0, s1));
+            }
+            halfScalar(row0 + 2 * x, row1 + 2 * x, dst + x, out_width - x);
+        }
+
+        // 16 个像素（每通道 16 位，256 位寄存器）的加权和，结果按像素顺序排列
+        __attribute__((target("avx2"))) inline __m256i weigh16(__m256i c0, __m256i c1, __m256i c2, __m256i k01, __m256i k2r)
+        {
+            const __m256i one = _mm256_set1_epi16(1);
+            const __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(c0, c1), k01),
+                                                _mm256_madd_epi16(_mm256_unpacklo_epi16(c2, one), k2r));
+            const __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(c0, c1), k01),
+                                                _mm256_madd_epi16(_mm256_unpackhi_epi16(c2, one), k2r));
+            // unpack/pack 均按 128 位通道进行，两次操作后像素顺序恢复
+            return _mm256_packs_epi32(_mm256_srli_epi32(lo, SHIFT), _mm256_srli_epi32(hi, SHIFT));
+        }
+
+        __attribute__((target("avx2"))) void rowAvx2(const uint8_t *src, uint8_t *dst, int width, const Coeffs &k)
+        {
+            const ShuffleMasks &m = shuffleMasks();
+            const __m256i k01 = _mm256_set1_epi32((k.k1 << 16) | k.k0);
+            const __m256i k2r = _mm256_set1_epi32((ROUND << 16) | k.k2);
+
+            int x = 0;
+            for (; x + 32 <= width; x += 32)
+            {
+                __m128i a0, a1, a2, b0, b1, b2;
+                deinterleave16(src + 3 * x, m, a0, a1, a2);
+                deinterleave16(src + 3 * x + 48, m, b0, b1, b2);
+
+                const __m256i ga = weigh16(_mm256_cvtepu8_epi16(a0), _mm256_cvtepu8_epi16(a1), _mm256_cvtepu8_epi16(a2), k01, k2r);
+                const __m256i gb = weigh16(_mm256_cvtepu8_epi16(b0), _mm256_cvtepu8_epi16(b1), _mm256_cvtepu8_epi16(b2), k01, k2r);
+
+                // packus 按 128 位通道交错，重新排列为 0..31 的像素顺序
+                const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(ga, gb), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), packed);
+            }
+            rowSse41(src + 3 * x, dst + x, width - x, k);
+        }
+
+        bool cpuHasSse41()
+        {
+            return __builtin_cpu_supports("sse4.1");
+        }
+
+        bool cpuHasAvx2()
+        {
+            return __builtin_cpu_supports("avx2");
+        }
+#endif
+
+#if defined(COLOR_CONVERT_NEON)
+        /*::::::::::::::::::::::::::::::::::::::::::::::::::::::: NEON 实现 ::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
+        inline uint8x8_t weigh8Neon(uint16x8_t c0, uint16x8_t c1, uint16x8_t c2, const Coeffs &k)
+        {
+            const uint32x4_t round = vdupq_n_u32(ROUND);
+            uint32x4_t lo = vmlal_n_u16(round, vget_low_u16(c0), k.k0);
+            lo = vmlal_n_u16(lo, vget_low_u16(c1), k.k1);
+            lo = vmlal_n_u16(lo, vget_low_u16(c2), k.k2);
+            uint32x4_t hi = vmlal_n_u16(round, vget_high_u16(c0), k.k0);
+            hi = vmlal_n_u16(hi, vget_high_u16(c1), k.k1);
+            hi = vmlal_n_u16(hi, vget_high_u16(c2), k.k2);
+            return vqmovn_u16(vcombine_u16(vshrn_n_u32(lo, SHIFT), vshrn_n_u32(hi, SHIFT)));
+        }
+
+        void rowNeon(const uint8_t *src, uint8_t *dst, int width, const Coeffs &k)
+        {
+            int x = 0;
+            for (; x + 16 <= width; x += 16)
+            {
+                const uint8x16x3_t px = vld3q_u8(src + 3 * x); // 硬件解交织
+                const uint8x8_t lo = weigh8Neon(vmovl_u8(vget_low_u8(px.val[0])), vmovl_u8(vget_low_u8(px.val[1])), vmovl_u8(vget_low_u8(px.val[2])), k);
+                const uint8x8_t hi = weigh8Neon(vmovl_u8(vget_high_u8(px.val[0])), vmovl_u8(vget_high_u8(px.val[1])), vmovl_u8(vget_high_u8(px.val[2])), k);
+                vst1q_u8(dst + x, vcombine_u8(lo, hi));
+            }
+            rowScalar(src + 3 * x, dst + x, width - x, k);
+        }
+
+        void halfNeon(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int out_width)
+        {
+            int x = 0;
+            for (; x + 8 <= out_width; x += 8)
+            {
+                // 相邻两字节成对相加，再加上下一行，最后 (sum + 2) >> 2
+                const uint16x8_t sum = vaddq_u16(vpaddlq_u8(vld1q_u8(row0 + 2 * x)), vpaddlq_u8(vld1q_u8(row1 + 2 * x)));
+                vst1_u8(dst + x, vrshrn_n_u16(sum, 2));
+            }
+            halfScalar(row0 + 2 * x, row1 + 2 * x, dst + x, out_width - x);
+        }
+#endif
+
+        /*::::::::::::::::::::::::::::::::::::::::::::::::::::::: 运行时选择 ::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
+        struct Dispatch
+        {
+            Isa isa = Isa::SCALAR;
+            RowKernel row = rowScalar;
+            HalfKernel half = halfScalar;
+        };
+
+        bool isaSupported(Isa isa)
+        {
+            switch (isa)
+            {
+                case Isa::SCALAR:
+                    return true;
+#if defined(COLOR_CONVERT_X86)
+                case Isa::SSE41:
+                    return cpuHasSse41();
+                case Isa::AVX2:
+                    return cpuHasAvx2() && cpuHasSse41();
+#endif
+#if defined(COLOR_CONVERT_NEON)
+                case Isa::NEON:
+                    return true;
+#endif
+                default:
+                    return false;
+            }
+        }
+
+        Dispatch makeDispatch(Isa isa)
+        {
+            Dispatch d;
+            d.isa = isa;
+            switch (isa)
+            {
+#if defined(COLOR_CONVERT_X86)
+                case Isa::SSE41:
+                    d.row = rowSse41;
+                    d.half = halfSse41;
+                    break;
+                case Isa::AVX2:
+                    d.row = rowAvx2;
+                    d.half = halfSse41; // 降采样均值阶段数据量小，复用 SSE4.1 版本
+                    break;
+#endif
+#if defined(COLOR_CONVERT_NEON)
+                case Isa::NEON:
+                    d.row = rowNeon;
+                    d.half = halfNeon;
+                    break;
+#endif
+                default:
+                    d.isa = Isa::SCALAR;
+                    break;
+            }
+            return d;
+        }
+
+        // 在覆盖各种尾部长度的合成图像上与标量实现逐位比对
+        bool matchesReference(const Dispatch &d)
+        {
+            const int width = 131, height = 6; // 非 16/32 整数倍，覆盖向量尾部
+            std::vector<uint8_t> src(static_cast<size_t>(width) * height * 3);
+            uint32_t seed = 0x12345678u;
+            for (uint8_t &v : src)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                v = static_cast<uint8_t>(seed >> 24);
+            }
+            src[0] = src[1] = src[2] = 255; // 覆盖最大值边界
+            src[3] = src[4] = src[5] = 0;   // 覆盖最小值边界
+
+            for (ChannelOrder order : {ChannelOrder::RGB, ChannelOrder::BGR})
+            {
+                const Coeffs k = coeffsFor(order);
+                std::vector<uint8_t> ref(width), out(width);
+                for (int y = 0; y < height; ++y)
+                {
+                    rowScalar(src.data() + static_cast<size_t>(y) * width * 3, ref.data(), width, k);
+                    d.row(src.data() + static_cast<size_t>(y) * width * 3, out.data(), width, k);
+                    if (ref != out)
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            std::vector<uint8_t> ref(width / 2), out(width / 2);
+            halfScalar(src.data(), src.data() + width, ref.data(), width / 2);
+            d.half(src.data(), src.data() + width, out.data(), width / 2);
+            return ref == out;
+        }
+
+        // 各指令集的内核表（只读，首次使用时构造；本平台未编译的指令集为标量实现）
+        const Dispatch &dispatchFor(Isa isa)
+        {
+            static const Dispatch table[] = {makeDispatch(Isa::SCALAR), makeDispatch(Isa::SSE41),
+                                             makeDispatch(Isa::AVX2), makeDispatch(Isa::NEON)};
+            return table[static_cast<int>(isa)];
+        }
+
+        // 选择当前CPU上最快且通过校验的实现
+        const Dispatch *selectDispatch()
+        {
+            for (Isa isa : {Isa::AVX2, Isa::SSE41, Isa::NEON})
+            {
+                if (!isaSupported(isa))
+                {
+                    continue;
+                }
+                if (matchesReference(dispatchFor(isa)))
+                {
+                    return &dispatchFor(isa);
+                }
+                std::cerr << "颜色转换内核 " << isaName(isa) << " 与参考实现不一致，已禁用" << std::endl;
+            }
+            return &dispatchFor(Isa::SCALAR);
+        }
+
+        std::atomic<const Dispatch *> forced_dispatch{nullptr}; // setIsa 强制使用的实现
+
+        // 当前实现：选择结果缓存在局部静态变量中（初始化线程安全），之后每帧调用不加锁
+        const Dispatch &dispatch()
+        {
+            static const Dispatch *const selected = selectDispatch();
+            const Dispatch *forced = forced_dispatch.load(std::memory_order_acquire);
+            return forced != nullptr ? *forced : *selected;
+        }
+
+        // 逐行转换，每两行再做一次 2x2 均值（两行灰度只在 L1 中停留，源数据只读一遍）
+        void toGrayHalfWith(const Dispatch &d, const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                            int width, int height, ChannelOrder order)
+        {
+            const Coeffs k = coeffsFor(order);
+            const int out_width = width / 2;
+            const int out_height = height / 2;
+
+            thread_local std::vector<uint8_t> rows;
+            rows.resize(static_cast<size_t>(width) * 2);
+            uint8_t *row0 = rows.data();
+            uint8_t *row1 = rows.data() + width;
+
+            for (int y = 0; y < out_height; ++y)
+            {
+                d.row(src + (2 * y) * src_step, row0, width, k);
+                d.row(src + (2 * y + 1) * src_step, row1, width, k);
+                d.half(row0, row1, dst + y * dst_step, out_width);
+            }
+        }
+    } // namespace
+
+    Isa activeIsa()
+    {
+        return dispatch().isa;
+    }
+
+    const char *isaName(Isa isa)
+    {
+        switch (isa)
+        {
+            case Isa::SSE41:
+                return "SSE4.1";
+            case Isa::AVX2:
+                return "AVX2";
+            case Isa::NEON:
+                return "NEON";
+            default:
+                return "SCALAR";
+        }
+    }
+
+    bool isaAvailable(Isa isa)
+    {
+        return isaSupported(isa);
+    }
+
+    bool setIsa(Isa isa)
+    {
+        if (!isaSupported(isa))
+        {
+            return false;
+        }
+        const Dispatch &candidate = dispatchFor(isa);
+        if (!matchesReference(candidate))
+        {
+            return false;
+        }
+
+        forced_dispatch.store(&candidate, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 三通道图像转灰度
+     * @param src 源图像首地址
+     * @param src_step 源图像行步长(字节)
+     * @param dst 目标灰度图首地址
+     * @param dst_step 目标图像行步长(字节)
+     * @param width 图像宽度
+     * @param height 图像高度
+     * @param order 源图像通道顺序
+     */
+    void toGray(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                int width, int height, ChannelOrder order)
+    {
+        const Dispatch &d = dispatch();
+        const Coeffs k = coeffsFor(order);
+        for (int y = 0; y < height; ++y)
+        {
+            d.row(src + y * src_step, dst + y * dst_step, width, k);
+        }
+    }
+
+    /**
+     * @brief 三通道图像转灰度并 2x2 降采样
+     * 参数同 toGray，目标图像尺寸为 (width/2) x (height/2)，奇数的最后一行/列被舍弃
+     */
+    void toGrayHalf(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                    int width, int height, ChannelOrder order)
+    {
+        toGrayHalfWith(dispatch(), src, src_step, dst, dst_step, width, height, order);
+    }
+
+    namespace Reference
+    {
+        void toGray(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                    int width, int height, ChannelOrder order)
+        {
+            const Coeffs k = coeffsFor(order);
+            for (int y = 0; y < height; ++y)
+            {
+                rowScalar(src + y * src_step, dst + y * dst_step, width, k);
+            }
+        }
+
+        void toGrayHalf(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step,
+                        int width, int height, ChannelOrder order)
+        {
+            toGrayHalfWith(Dispatch(), src, src_step, dst, dst_step, width, height, order);
+        }
+    } // namespace Reference
+
+    /*::::::::::::::::::::::::::::::::::::::::::::::::::::::: cv::Mat 封装 :::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
+    void toGray(const cv::Mat &src, cv::Mat &dst, ChannelOrder order)
+    {
+        CV_Assert(src.type() == CV_8UC3);
+        dst.create(src.rows, src.cols, CV_8UC1);
+        toGray(src.data, src.step, dst.data, dst.step, src.cols, src.rows, order);
+    }
+
+    void toGrayHalf(const cv::Mat &src, cv::Mat &dst, ChannelOrder order)
+    {
+        CV_Assert(src.type() == CV_8UC3);
+        dst.create(src.rows / 2, src.cols / 2, CV_8UC1);
+        toGrayHalf(src.data, src.step, dst.data, dst.step, src.cols, src.rows, order);
+    }
+
+    void toGrayRoi(const cv::Mat &src, const cv::Rect &roi, cv::Mat &dst, ChannelOrder order)
+    {
+        const cv::Rect clipped = roi & cv::Rect(0, 0, src.cols, src.rows);
+        toGray(src(clipped), dst, order);
+    }
+} // namespace ColorConvert
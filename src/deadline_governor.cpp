@@ -0,0 +1,186 @@
+#include "deadline_governor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float EWMA_ALPHA = 0.1f;            // 帧周期和检测耗时的滑动平均系数
+    constexpr int64_t FPS_WINDOW_NS = 1000000000; // 帧率统计窗口（1秒）
+}
+
+/**
+ * @brief 设置参数（同时清除状态和统计）
+ * @param params 预算参数
+ */
+void DeadlineGovernor::setParams(const DeadlineParams &params)
+{
+    params_ = params;
+    level_ = 0;
+    over_run_ = 0;
+    under_run_ = 0;
+    last_sequence_ = 0;
+    last_capture_ns_ = 0;
+    period_ms_ = 0.0f;
+    detect_ms_ = 0.0f;
+    window_start_ns_ = 0;
+    window_frames_ = 0;
+
+    frames_.store(0, std::memory_order_relaxed);
+    light_frames_.store(0, std::memory_order_relaxed);
+    skipped_.store(0, std::memory_order_relaxed);
+    overruns_.store(0, std::memory_order_relaxed);
+    level_snapshot_.store(0, std::memory_order_relaxed);
+    effective_fps_.store(0.0f, std::memory_order_relaxed);
+    budget_snapshot_.store(0.0f, std::memory_order_relaxed);
+    detect_snapshot_.store(0.0f, std::memory_order_relaxed);
+    period_snapshot_.store(0.0f, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 当前预算(ms)
+ */
+float DeadlineGovernor::budgetMs() const
+{
+    return params_.budget_ms > 0.0f ? params_.budget_ms : period_ms_ * params_.budget_ratio;
+}
+
+/**
+ * @brief 当前等级对应的降采样倍数系数
+ */
+float DeadlineGovernor::decimateScale() const
+{
+    return level_ > 0 ? std::pow(params_.level_scale, static_cast<float>(level_)) : 1.0f;
+}
+
+/**
+ * @brief 判断取到的帧是否值得检测
+ *
+ * 检测线程只取最新帧，被覆盖的帧不会经过这里，因此帧周期按采集时刻差除以帧序号差估计，
+ * 检测变慢时不会把周期估大（否则预算跟着变大，永远检测不到超预算）。
+ */
+bool DeadlineGovernor::admit(uint64_t sequence, int64_t capture_ns, int64_t now_ns)
+{
+    if (capture_ns <= 0)
+    {
+        return true; // 没有采集时刻，无法判断
+    }
+
+    if (last_capture_ns_ > 0 && sequence > last_sequence_ && capture_ns > last_capture_ns_)
+    {
+        const float period_ms = (capture_ns - last_capture_ns_) * 1e-6f / static_cast<float>(sequence - last_sequence_);
+        period_ms_ = period_ms_ > 0.0f ? period_ms_ + EWMA_ALPHA * (period_ms - period_ms_) : period_ms;
+        period_snapshot_.store(period_ms_, std::memory_order_relaxed);
+    }
+    last_sequence_ = sequence;
+    last_capture_ns_ = capture_ns;
+
+    if (!params_.enabled)
+    {
+        return true;
+    }
+    const float max_age_ms = params_.max_age_ms > 0.0f ? params_.max_age_ms : 2.0f * period_ms_;
+    if (max_age_ms > 0.0f && (now_ns - capture_ns) * 1e-6f > max_age_ms)
+    {
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return false; // 帧已过旧：检测完也已失去时效，等待下一帧
+    }
+    return true;
+}
+
+/**
+ * @brief 计入帧数和帧率（每满一秒结算一次帧率）
+ */
+void DeadlineGovernor::countFrame(int64_t end_ns)
+{
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    if (window_start_ns_ == 0)
+    {
+        window_start_ns_ = end_ns;
+    }
+    ++window_frames_;
+    if (end_ns - window_start_ns_ >= FPS_WINDOW_NS)
+    {
+        effective_fps_.store(window_frames_ * 1e9f / static_cast<float>(end_ns - window_start_ns_), std::memory_order_relaxed);
+        window_start_ns_ = end_ns;
+        window_frames_ = 0;
+    }
+}
+
+/**
+ * @brief 记录一帧未完整检测的结果：只计入帧率
+ *
+ * 画面复用和光流跟踪只需微秒级，若参与调节会清零连续超预算计数并累计恢复条件，
+ * 使等级永远升不上去或在廉价帧上恢复，失去对完整检测延迟的约束。
+ */
+void DeadlineGovernor::completeLight(int64_t end_ns)
+{
+    light_frames_.fetch_add(1, std::memory_order_relaxed);
+    countFrame(end_ns);
+}
+
+/**
+ * @brief 记录一帧完整检测完成，按耗时调整降采样等级
+ */
+void DeadlineGovernor::complete(int64_t start_ns, int64_t end_ns)
+{
+    const float detect_ms = (end_ns - start_ns) * 1e-6f;
+    detect_ms_ = detect_ms_ > 0.0f ? detect_ms_ + EWMA_ALPHA * (detect_ms - detect_ms_) : detect_ms;
+    detect_snapshot_.store(detect_ms_, std::memory_order_relaxed);
+    countFrame(end_ns);
+
+    const float budget_ms = budgetMs();
+    budget_snapshot_.store(budget_ms, std::memory_order_relaxed);
+    if (budget_ms <= 0.0f)
+    {
+        return; // 帧周期还未知
+    }
+
+    if (detect_ms > budget_ms)
+    {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        under_run_ = 0;
+        if (params_.enabled && ++over_run_ >= params_.escalate_after && level_ < params_.max_level)
+        {
+            ++level_;
+            over_run_ = 0;
+        }
+    }
+    else
+    {
+        over_run_ = 0;
+        // 降一级后的耗时按像素数估计（与降采样倍数的平方成正比，解码部分不变，估计偏保守）
+        const float lower_ms = detect_ms * params_.level_scale * params_.level_scale;
+        if (level_ > 0 && lower_ms < budget_ms * params_.recover_ratio)
+        {
+            if (++under_run_ >= params_.recover_after)
+            {
+                --level_;
+                under_run_ = 0;
+            }
+        }
+        else
+        {
+            under_run_ = 0; // 降级后可能超预算：保持当前等级
+        }
+    }
+    level_snapshot_.store(level_, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 获取统计（可在其他线程调用）
+ */
+DeadlineStats DeadlineGovernor::stats() const
+{
+    DeadlineStats stats;
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.light_frames = light_frames_.load(std::memory_order_relaxed);
+    stats.skipped = skipped_.load(std::memory_order_relaxed);
+    stats.overruns = overruns_.load(std::memory_order_relaxed);
+    stats.level = level_snapshot_.load(std::memory_order_relaxed);
+    stats.effective_fps = effective_fps_.load(std::memory_order_relaxed);
+    stats.budget_ms = budget_snapshot_.load(std::memory_order_relaxed);
+    stats.detect_ms = detect_snapshot_.load(std::memory_order_relaxed);
+    stats.period_ms = period_snapshot_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,88 @@
+#include "detector_profile.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief 构造函数，加载默认档位表
+ *
+ * 默认档位（按高度由低到高）：
+ *  - NEAR : 1.5m 以下，标签占满画面，降采样 3 倍、不模糊、2 线程
+ *  - LOW  : 1.5~4m，降采样 2 倍
+ *  - MID  : 4~8m，降采样 1.5 倍，轻度模糊
+ *  - HIGH : 8m 以上，全分辨率（与原固定参数一致）
+ */
+DetectorProfileScheduler::DetectorProfileScheduler()
+{
+    profiles_ = {
+        {"NEAR", 0.0f, 3.0f, 0.0f, 2},
+        {"LOW", 1.5f, 2.0f, 0.0f, 4},
+        {"MID", 4.0f, 1.5f, 0.2f, 4},
+        {"HIGH", 8.0f, 1.0f, 0.2f, 4},
+    };
+    current_index_ = profiles_.size() - 1; // 起始使用最精细的档位
+}
+
+// 设置档位表
+void DetectorProfileScheduler::setProfiles(const std::vector<DetectorProfile> &profiles)
+{
+    if (profiles.empty())
+    {
+        return;
+    }
+    profiles_ = profiles;
+    std::sort(profiles_.begin(), profiles_.end(), [](const DetectorProfile &a, const DetectorProfile &b)
+              { return a.min_altitude < b.min_altitude; });
+    current_index_ = profiles_.size() - 1;
+}
+
+// 设置高度切换迟滞
+void DetectorProfileScheduler::setHysteresis(float hysteresis_m)
+{
+    hysteresis_m_ = std::max(0.0f, hysteresis_m);
+}
+
+// 设置降采样后标签的最小边长
+void DetectorProfileScheduler::setMinTagSidePx(float min_side_px)
+{
+    min_tag_side_px_ = std::max(1.0f, min_side_px);
+}
+
+/**
+ * @brief 选择本帧使用的检测器档位
+ * @param altitude_m 当前相对高度(m)
+ * @param tag_area_px 上一次检测到的标签像素面积，未检测到时传 0
+ * @return 选中的档位
+ */
+const DetectorProfile &DetectorProfileScheduler::select(float altitude_m, float tag_area_px)
+{
+    // 1. 按高度确定档位，仅当越过边界超过迟滞量时才切换
+    size_t index = current_index_;
+    while (index + 1 < profiles_.size() && altitude_m >= profiles_[index + 1].min_altitude + hysteresis_m_)
+    {
+        index++;
+    }
+    while (index > 0 && altitude_m < profiles_[index].min_altitude - hysteresis_m_)
+    {
+        index--;
+    }
+
+    // 2. 标签在当前降采样倍数下过小时，退回到更精细的档位
+    if (tag_area_px > 0.0f)
+    {
+        const float side = std::sqrt(tag_area_px);
+        while (index + 1 < profiles_.size() && side / profiles_[index].quad_decimate < min_tag_side_px_)
+        {
+            index++;
+        }
+    }
+
+    current_index_ = index;
+    return profiles_[current_index_];
+}
+
+// 获取当前档位
+const DetectorProfile &DetectorProfileScheduler::current() const
+{
+    return profiles_[current_index_];
+}
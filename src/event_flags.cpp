@@ -0,0 +1,86 @@
+#include "event_flags.hpp"
+#include "latency_histogram.hpp"
+
+#include <chrono>
+
+void EventFlags::post(uint32_t bits)
+{
+    if (bits == 0)
+    {
+        return;
+    }
+    posted_.fetch_add(1, std::memory_order_relaxed);
+
+    // 先记录首次挂起时刻再置位，保证 take 取到某一位时能看到它的挂起时刻
+    const int64_t now = steadyNowNs();
+    for (int i = 0; i < BITS; ++i)
+    {
+        if (bits & (1u << i))
+        {
+            int64_t expected = 0;
+            since_ns_[i].compare_exchange_strong(expected, now, std::memory_order_relaxed);
+        }
+    }
+
+    const uint32_t prev = pending_.fetch_or(bits, std::memory_order_release);
+    if ((prev & bits) == bits)
+    {
+        coalesced_.fetch_add(1, std::memory_order_relaxed); // 这些位都已挂起，等待者必然会处理
+        return;
+    }
+
+    // 加锁后再通知，避免等待者检查 pending_ 之后、进入等待之前错过通知
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cv_.notify_one();
+}
+
+uint32_t EventFlags::take(uint32_t mask, int64_t *since_ns)
+{
+    const uint32_t bits = pending_.fetch_and(~mask, std::memory_order_acquire) & mask;
+    int64_t earliest = 0;
+    for (int i = 0; i < BITS; ++i)
+    {
+        if (bits & (1u << i))
+        {
+            const int64_t since = since_ns_[i].exchange(0, std::memory_order_relaxed);
+            if (since > 0 && (earliest == 0 || since < earliest))
+            {
+                earliest = since;
+            }
+        }
+    }
+    if (since_ns != nullptr && earliest > 0)
+    {
+        *since_ns = earliest;
+    }
+    return bits;
+}
+
+bool EventFlags::waitUntil(int64_t deadline_ns)
+{
+    if (pending_.load(std::memory_order_acquire) != 0)
+    {
+        return true;
+    }
+
+    const std::chrono::steady_clock::time_point deadline{std::chrono::nanoseconds(deadline_ns)};
+    std::unique_lock<std::mutex> lock(mutex_);
+    const bool woken = cv_.wait_until(lock, deadline, [this]()
+                                      { return pending_.load(std::memory_order_acquire) != 0; });
+    if (woken)
+    {
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return woken;
+}
+
+EventStats EventFlags::stats() const
+{
+    EventStats stats;
+    stats.posted = posted_.load(std::memory_order_relaxed);
+    stats.wakeups = wakeups_.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+    return stats;
+}
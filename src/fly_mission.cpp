@@ -196,115 +196,14 @@ static std::vector<mavsdk::Mission::MissionItem> create_custom_waypoints()
 }
 
 /**
- * 上传航点任务到无人机
+ * 加载任务航点：根据文件或自定义创建航点
  *
- * @param mission MAVSDK任务插件实例
- * @param mission_items 任务航点列表
- * @return 上传成功返回true，失败返回false
- */
-static bool upload_mission(mavsdk::Mission &mission, const std::vector<mavsdk::Mission::MissionItem> &mission_items)
-{
-    if (mission_items.empty())
-    {
-        std::cerr << "无法上传空任务" << std::endl;
-        return false;
-    }
-
-    std::cout << "清除现有任务..." << std::endl;
-    mission.clear_mission();
-
-    std::cout << "上传任务到无人机..." << std::endl;
-    Mission::MissionPlan mission_plan{};
-    mission_plan.mission_items = mission_items;
-
-    const Mission::Result upload_result = mission.upload_mission(mission_plan);
-
-    if (upload_result != Mission::Result::Success)
-    {
-        std::cerr << "航线任务上传失败: " << upload_result << std::endl;
-        return false;
-    }
-
-    std::cout << "任务上传成功，共" << mission_items.size() << "个航点" << std::endl;
-    return true;
-}
-
-/**
- * 执行航点任务并监控状态
- *
- * @param action MAVSDK动作插件实例
- * @param mission MAVSDK任务插件实例
- * @return 任务完成返回true，失败返回false
- */
-static bool execute_and_monitor_mission(mavsdk::Action &action, mavsdk::Mission &mission)
-{
-    // 解锁无人机准备起飞
-    std::cout << "准备解锁..." << std::endl;
-    const Action::Result arm_result = action.arm();
-    if (arm_result != Action::Result::Success)
-    {
-        std::cerr << "解锁失败: " << arm_result << std::endl;
-        return false;
-    }
-    std::cout << "解锁成功" << std::endl;
-
-    // 订阅任务进度回调函数
-    mission.subscribe_mission_progress(
-        [](Mission::MissionProgress progress)
-        {
-            std::cout << "当前航点: " << progress.current << " / " << progress.total << '\n';
-        });
-
-    // 开始执行任务
-    std::cout << "开始航点任务..." << std::endl;
-    Mission::Result start_result = mission.start_mission();
-    if (start_result != Mission::Result::Success)
-    {
-        std::cerr << "启动任务失败: " << start_result << std::endl;
-        return false;
-    }
-
-    // 等待任务完成，设置超时时间
-    const int timeout_seconds = 300; // 5分钟超时
-    std::cout << "等待任务完成，超时时间: " << timeout_seconds << "秒..." << std::endl;
-
-    auto start_time = std::chrono::steady_clock::now();
-
-    // 循环检查任务是否完成
-    while (std::chrono::steady_clock::now() - start_time < std::chrono::seconds(timeout_seconds))
-    {
-        // 使用is_mission_finished()同步检查任务状态
-        auto [result, is_finished] = mission.is_mission_finished();
-
-        if (result == Mission::Result::Success)
-        {
-            if (is_finished)
-            {
-                std::cout << "任务已成功完成" << std::endl;
-                return true;
-            }
-        }
-        else
-        {
-            std::cerr << "检查任务状态失败: " << result << std::endl;
-        }
-
-        // 短暂休眠避免CPU占用过高
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    }
-
-    std::cerr << "任务执行超时，未在指定时间内完成" << std::endl;
-    return false;
-}
-
-/**
- * 综合函数：根据文件或自定义创建航点，上传并执行任务
- *
- * @param mavsdk MAVSDK成员集合
  * @param plan_file 任务文件路径，为空则使用自定义航点
- * @return 执行成功返回0，失败返回错误码
+ * @return 任务航点列表，读取失败时为空
+ *
+ * 上传和执行由任务引擎中的航点任务步骤异步完成（见 mission_task.hpp）。
  */
-int fly_mission(Mavsdk_members &mavsdk, const std::string &plan_file)
+std::vector<Mission::MissionItem> load_mission_items(const std::string &plan_file)
 {
     std::vector<Mission::MissionItem> mission_items;
 
@@ -315,8 +214,7 @@ int fly_mission(Mavsdk_members &mavsdk, const std::string &plan_file)
         mission_items = read_qgroundcontrol_plan(plan_file);
         if (mission_items.empty())
         {
-            std::cerr << "读取任务文件失败，退出" << std::endl;
-            return 0;
+            std::cerr << "读取任务文件失败" << std::endl;
         }
     }
     else
@@ -324,14 +222,7 @@ int fly_mission(Mavsdk_members &mavsdk, const std::string &plan_file)
         std::cout << "使用默认任务航点..." << std::endl;
         mission_items = create_custom_waypoints();
     }
-
-    if (!upload_mission(mavsdk.mission, mission_items))
-    {
-        return 0;
-    }
-
-    // 执行并监控任务
-    return execute_and_monitor_mission(mavsdk.action, mavsdk.mission);
+    return mission_items;
 }
 
 /**
@@ -0,0 +1,236 @@
+#include "frame_bus.hpp"
+
+#include <algorithm>
+
+FrameSubscription::FrameSubscription(const std::string &name, size_t depth, DropPolicy policy)
+    : name_(name), depth_(std::max<size_t>(depth, 1)), policy_(policy)
+{
+    if (depth_ == 1 && policy_ == DropPolicy::DROP_OLDEST)
+    {
+        mailbox_.reset(new LatestMailbox<FramePtr>());
+    }
+    else
+    {
+        ring_.resize(depth_);
+    }
+}
+
+/**
+ * @brief 入队（发布线程调用）
+ * @param frame 帧指针
+ *
+ * 信箱订阅只做一次原子交换；环形队列满时按丢弃策略丢掉最旧的帧或本帧。
+ * 两种方式都只在消费者正在阻塞等待时才唤醒它。
+ */
+void FrameSubscription::push(const FramePtr &frame)
+{
+    if (mailbox_)
+    {
+        if (!closed_.load())
+        {
+            mailbox_->publish(frame);
+        }
+        return;
+    }
+
+    FramePtr evicted; // 在锁外释放被挤掉的帧，避免在锁内归还帧池缓冲区
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_.load())
+        {
+            return;
+        }
+        if (count_ == ring_.size())
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            if (policy_ == DropPolicy::DROP_NEWEST)
+            {
+                return;
+            }
+            evicted = std::move(ring_[head_]);
+            head_ = (head_ + 1) % ring_.size();
+            --count_;
+        }
+        ring_[(head_ + count_) % ring_.size()] = frame;
+        ++count_;
+        wake = waiters_ > 0;
+    }
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+    if (wake)
+    {
+        cond_.notify_one();
+    }
+}
+
+bool FrameSubscription::takeFromRing(FramePtr &out)
+{
+    if (count_ == 0)
+    {
+        return false;
+    }
+    out = std::move(ring_[head_]);
+    head_ = (head_ + 1) % ring_.size();
+    --count_;
+    taken_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief 取出队首的帧（不阻塞）
+ * @param out 输出帧指针
+ * @return 队列为空时返回false
+ */
+bool FrameSubscription::tryTake(FramePtr &out)
+{
+    if (mailbox_)
+    {
+        if (closed_.load())
+        {
+            FramePtr released;
+            mailbox_->tryTake(released); // 关闭后由消费者释放信箱中残留的帧
+            return false;
+        }
+        return mailbox_->tryTake(out);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return takeFromRing(out);
+}
+
+/**
+ * @brief 等待并取出队首的帧
+ * @param out 输出帧指针
+ * @param timeout 最长等待时间
+ * @return 超时或订阅关闭时返回false
+ */
+bool FrameSubscription::waitTake(FramePtr &out, std::chrono::milliseconds timeout)
+{
+    if (mailbox_)
+    {
+        if (mailbox_->waitTake(out, timeout))
+        {
+            return true;
+        }
+        return tryTake(out); // 已关闭时由此释放信箱中残留的帧
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (count_ == 0 && !closed_.load())
+    {
+        ++waiters_;
+        cond_.wait_for(lock, timeout, [this]
+                       { return closed_.load() || count_ > 0; });
+        --waiters_;
+    }
+    return !closed_.load() && takeFromRing(out);
+}
+
+/**
+ * @brief 关闭订阅并唤醒等待者
+ *
+ * 信箱中残留的帧不能由关闭线程清空（信箱只允许一个生产者和一个消费者），由消费者下一次取帧或订阅析构时释放。
+ */
+void FrameSubscription::close()
+{
+    if (mailbox_)
+    {
+        closed_ = true;
+        mailbox_->close();
+        return;
+    }
+
+    std::vector<FramePtr> released; // 在锁外释放队列中的帧
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        for (; count_ > 0; --count_)
+        {
+            released.push_back(std::move(ring_[head_]));
+            head_ = (head_ + 1) % ring_.size();
+        }
+    }
+    cond_.notify_all();
+}
+
+/**
+ * @brief 订阅者统计
+ */
+SubscriberStats FrameSubscription::stats() const
+{
+    SubscriberStats stats;
+    stats.name = name_;
+    stats.depth = depth_;
+    if (mailbox_)
+    {
+        stats.delivered = mailbox_->published();
+        stats.dropped = mailbox_->dropped();
+        stats.taken = mailbox_->taken();
+        return stats;
+    }
+    stats.delivered = delivered_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.taken = taken_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::shared_ptr<FrameSubscription> FrameBus::subscribe(const std::string &name, size_t depth, DropPolicy policy)
+{
+    auto subscription = std::make_shared<FrameSubscription>(name, depth, policy);
+
+    std::lock_guard<std::mutex> lock(modify_mutex_);
+    auto list = std::make_shared<SubscriberList>(*std::atomic_load(&subscribers_));
+    list->push_back(subscription);
+    std::atomic_store(&subscribers_, std::shared_ptr<const SubscriberList>(std::move(list)));
+    return subscription;
+}
+
+void FrameBus::unsubscribe(const std::shared_ptr<FrameSubscription> &subscription)
+{
+    if (!subscription)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(modify_mutex_);
+        auto list = std::make_shared<SubscriberList>(*std::atomic_load(&subscribers_));
+        list->erase(std::remove(list->begin(), list->end(), subscription), list->end());
+        std::atomic_store(&subscribers_, std::shared_ptr<const SubscriberList>(std::move(list)));
+    }
+    subscription->close();
+}
+
+/**
+ * @brief 发布一帧
+ * @param frame 帧指针（发布后不得再修改帧内容）
+ */
+void FrameBus::publish(FramePtr frame)
+{
+    published_.fetch_add(1, std::memory_order_relaxed);
+    const std::shared_ptr<const SubscriberList> list = std::atomic_load(&subscribers_);
+    for (const std::shared_ptr<FrameSubscription> &subscription : *list)
+    {
+        subscription->push(frame);
+    }
+}
+
+void FrameBus::close()
+{
+    const std::shared_ptr<const SubscriberList> list = std::atomic_load(&subscribers_);
+    for (const std::shared_ptr<FrameSubscription> &subscription : *list)
+    {
+        subscription->close();
+    }
+}
+
+std::vector<SubscriberStats> FrameBus::stats() const
+{
+    const std::shared_ptr<const SubscriberList> list = std::atomic_load(&subscribers_);
+    std::vector<SubscriberStats> stats;
+    stats.reserve(list->size());
+    for (const std::shared_ptr<FrameSubscription> &subscription : *list)
+    {
+        stats.push_back(subscription->stats());
+    }
+    return stats;
+}
@@ -0,0 +1,113 @@
+#include "frame_pool.hpp"
+
+#include <cstdlib>
+
+// 单块缓冲区：对齐分配的连续内存
+struct FramePool::Block
+{
+    uint8_t *data = nullptr;
+    size_t bytes = 0;
+
+    explicit Block(size_t size) : bytes(size)
+    {
+        data = static_cast<uint8_t *>(std::aligned_alloc(ROW_ALIGNMENT, size));
+        if (!data)
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    ~Block()
+    {
+        std::free(data);
+    }
+
+    Block(const Block &) = delete;
+    Block &operator=(const Block &) = delete;
+};
+
+// 帧池共享状态，缓冲区的删除器持有它，保证帧池先于缓冲区析构时也不会悬空
+struct FramePool::State
+{
+    std::mutex mutex;                               // 保护空闲链表
+    std::vector<std::unique_ptr<Block>> free_list; // 空闲缓冲区
+    size_t block_bytes = 0;                         // 当前缓冲区尺寸
+    size_t max_free = 0;                            // 最多缓存的空闲缓冲区数量
+
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> reuses{0};
+
+    // 归还缓冲区：尺寸已变化或空闲链表已满时直接释放
+    void release(Block *block)
+    {
+        std::unique_ptr<Block> owned(block);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (owned->bytes == block_bytes && free_list.size() < max_free)
+        {
+            free_list.push_back(std::move(owned));
+        }
+    }
+};
+
+FramePool::FramePool(size_t max_free_buffers) : state_(std::make_shared<State>())
+{
+    state_->max_free = max_free_buffers;
+}
+
+/**
+ * @brief 从帧池获取图像缓冲区
+ * @param rows 图像行数
+ * @param cols 图像列数
+ * @param type OpenCV 图像类型（如 CV_8UC1、CV_8UC3）
+ * @return 指向池内存的图像视图及其持有者
+ */
+PooledImage FramePool::acquire(int rows, int cols, int type)
+{
+    const size_t row_bytes = static_cast<size_t>(cols) * CV_ELEM_SIZE(type);
+    const size_t step = (row_bytes + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT; // 行步长向上对齐
+    const size_t bytes = step * static_cast<size_t>(rows);
+
+    std::unique_ptr<Block> block;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->block_bytes != bytes)
+        {
+            // 分辨率或格式变化，丢弃旧尺寸的空闲缓冲区
+            state_->free_list.clear();
+            state_->block_bytes = bytes;
+        }
+        if (!state_->free_list.empty())
+        {
+            block = std::move(state_->free_list.back());
+            state_->free_list.pop_back();
+        }
+    }
+
+    if (block)
+    {
+        state_->reuses++;
+    }
+    else
+    {
+        block = std::make_unique<Block>(bytes);
+        state_->allocations++;
+    }
+
+    PooledImage image;
+    image.mat = cv::Mat(rows, cols, type, block->data, step);
+
+    std::shared_ptr<State> state = state_;
+    image.holder = std::shared_ptr<void>(block.release(), [state](void *p)
+                                         { state->release(static_cast<Block *>(p)); });
+    return image;
+}
+
+uint64_t FramePool::allocations() const
+{
+    return state_->allocations.load();
+}
+
+uint64_t FramePool::reuses() const
+{
+    return state_->reuses.load();
+}
@@ -0,0 +1,638 @@
+#include "frame_recorder.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const char SEGMENT_MAGIC[8] = {'P', 'X', '4', 'R', 'E', 'C', '\0', '\0'}; // 分段文件标识
+    constexpr uint32_t SEGMENT_VERSION = 1;                                   // 格式版本
+    constexpr size_t MIN_SEGMENT_BYTES = 1u << 20;                            // 分段文件最小大小
+
+    // 按 RECORD_ALIGNMENT 向上取整
+    size_t alignRecord(size_t size)
+    {
+        const size_t a = FrameRecorder::RECORD_ALIGNMENT;
+        return (size + a - 1) / a * a;
+    }
+
+    // 分段文件名
+    std::string segmentName(uint64_t index)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "seg_%06llu.rec", static_cast<unsigned long long>(index));
+        return name;
+    }
+
+    bool isSegmentFile(const fs::path &path)
+    {
+        const std::string name = path.filename().string();
+        return name.size() > 8 && name.compare(0, 4, "seg_") == 0 && path.extension() == ".rec";
+    }
+} // namespace
+
+FrameRecorder::FrameRecorder() : frame_queue_(FRAME_QUEUE_DEPTH), detection_queue_(DETECTION_QUEUE_DEPTH) {}
+
+FrameRecorder::~FrameRecorder()
+{
+    stop();
+}
+
+/**
+ * @brief 开始录像
+ * @param config 录像配置
+ * @return 成功创建会话目录和第一个分段文件时返回true
+ */
+bool FrameRecorder::start(const RecorderConfig &config)
+{
+    if (recording_ || writer_thread_.joinable())
+    {
+        return false;
+    }
+    if (config.directory.empty())
+    {
+        std::cerr << "录像目录为空" << std::endl;
+        return false;
+    }
+
+    config_ = config;
+    config_.segment_bytes = alignRecord(std::max(config.segment_bytes, MIN_SEGMENT_BYTES));
+
+    // 以启动时间命名会话目录
+    char stamp[32];
+    const std::time_t now = std::time(nullptr);
+    std::tm tm_now{};
+    localtime_r(&now, &tm_now);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &tm_now);
+    session_dir_ = (fs::path(config_.directory) / stamp).string();
+
+    std::error_code ec;
+    fs::create_directories(session_dir_, ec);
+    if (ec)
+    {
+        std::cerr << "无法创建录像目录 " << session_dir_ << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    // 丢弃上一次停止时残留在队列中的记录（此时写线程未运行，本线程即消费者）
+    CameraFrame stale_frame;
+    while (frame_queue_.tryPop(stale_frame))
+    {
+    }
+    DetectionEntry stale_detection;
+    while (detection_queue_.tryPop(stale_detection))
+    {
+    }
+
+    finished_.clear();
+    frames_written_ = 0;
+    frames_dropped_ = 0;
+    detections_written_ = 0;
+    detections_dropped_ = 0;
+    bytes_written_ = 0;
+
+    if (!openSegment(0, current_))
+    {
+        return false;
+    }
+    openSegment(1, spare_); // 失败时换段会再尝试创建
+
+    recording_ = true;
+    writer_thread_ = std::thread(&FrameRecorder::writerLoop, this);
+    return true;
+}
+
+/**
+ * @brief 停止录像，写完队列中剩余的记录后关闭文件
+ */
+void FrameRecorder::stop()
+{
+    recording_ = false;
+    if (writer_thread_.joinable())
+    {
+        writer_thread_.join();
+    }
+    if (current_.valid())
+    {
+        closeSegment(current_, true);
+    }
+    if (spare_.valid())
+    {
+        closeSegment(spare_, false); // 未使用的预备分段直接删除
+    }
+}
+
+// 是否正在录像
+bool FrameRecorder::recording() const
+{
+    return recording_.load(std::memory_order_relaxed);
+}
+
+// 当前会话目录
+std::string FrameRecorder::sessionDirectory() const
+{
+    return session_dir_;
+}
+
+/**
+ * @brief 提交一帧（采集线程调用，不复制像素、不阻塞）
+ * @param frame 相机帧（使用其中的采集时间戳和仿真时间戳）
+ * @return 入队成功返回true；未在录像或队列已满时返回false
+ */
+bool FrameRecorder::recordFrame(const CameraFrame &frame)
+{
+    if (!recording() || frame.empty())
+    {
+        return false;
+    }
+
+    if (!frame_queue_.tryPush(frame))
+    {
+        frames_dropped_++;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 提交一帧的检测结果（检测线程调用，不分配内存、不阻塞）
+ * @param sequence 相机帧序号
+ * @param time_ns 检测完成时刻（steady_clock，纳秒）
+ * @param detections 检测到的标签（超过 MAX_TAGS_PER_RECORD 的部分不记录）
+ * @return 入队成功返回true
+ */
+bool FrameRecorder::recordDetections(uint64_t sequence, int64_t time_ns, const std::vector<TagDetection> &detections)
+{
+    if (!recording())
+    {
+        return false;
+    }
+
+    DetectionEntry entry;
+    entry.sequence = sequence;
+    entry.time_ns = time_ns;
+    entry.count = static_cast<uint32_t>(std::min(detections.size(), MAX_TAGS_PER_RECORD));
+    for (uint32_t i = 0; i < entry.count; ++i)
+    {
+        const TagDetection &det = detections[i];
+        RecordedTag &tag = entry.tags[i];
+        tag.id = det.id;
+        tag.hamming = det.hamming;
+        tag.decision_margin = det.decision_margin;
+        tag.center[0] = det.center.x;
+        tag.center[1] = det.center.y;
+        for (int k = 0; k < 4; ++k)
+        {
+            tag.corners[2 * k] = det.corners[k].x;
+            tag.corners[2 * k + 1] = det.corners[k].y;
+        }
+    }
+
+    if (!detection_queue_.tryPush(entry))
+    {
+        detections_dropped_++;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 写线程主循环：队列为空时短暂休眠，停止后写完剩余记录再退出
+ */
+void FrameRecorder::writerLoop()
+{
+    CameraFrame frame;
+    DetectionEntry detection_entry;
+
+    while (true)
+    {
+        bool idle = true;
+
+        while (detection_queue_.tryPop(detection_entry))
+        {
+            writeDetections(detection_entry);
+            idle = false;
+        }
+        if (frame_queue_.tryPop(frame))
+        {
+            writeFrame(frame);
+            frame = CameraFrame(); // 写完立即释放帧缓冲区引用
+            idle = false;
+        }
+
+        if (idle)
+        {
+            if (!recording())
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+// 写入帧记录（仅写灰度图，彩色帧在写线程中转换）
+void FrameRecorder::writeFrame(const CameraFrame &frame)
+{
+    const cv::Mat gray = frame.grayOrConvert();
+    if (gray.empty() || gray.type() != CV_8UC1)
+    {
+        frames_dropped_++;
+        return;
+    }
+
+    const size_t stride = gray.cols;
+    const size_t payload = stride * gray.rows;
+    RecordHeader *header = nullptr;
+    uint8_t *dst = reserveRecord(payload, header);
+    if (dst == nullptr)
+    {
+        frames_dropped_++;
+        return;
+    }
+
+    for (int y = 0; y < gray.rows; ++y)
+    {
+        std::memcpy(dst + y * stride, gray.ptr<uint8_t>(y), stride);
+    }
+
+    header->type = static_cast<uint32_t>(RecordType::FRAME);
+    header->payload_size = static_cast<uint32_t>(payload);
+    header->sequence = frame.sequence;
+    header->time_ns = frame.capture_ns;
+    header->sim_ns = frame.sim_ns;
+    header->width = gray.cols;
+    header->height = gray.rows;
+    header->stride = static_cast<uint32_t>(stride);
+    header->count = 0;
+
+    commitRecord(alignRecord(sizeof(RecordHeader) + payload));
+    frames_written_++;
+}
+
+// 写入检测记录
+void FrameRecorder::writeDetections(const DetectionEntry &entry)
+{
+    const size_t payload = entry.count * sizeof(RecordedTag);
+    RecordHeader *header = nullptr;
+    uint8_t *dst = reserveRecord(payload, header);
+    if (dst == nullptr)
+    {
+        detections_dropped_++;
+        return;
+    }
+
+    std::memcpy(dst, entry.tags, payload);
+
+    header->type = static_cast<uint32_t>(RecordType::DETECTION);
+    header->payload_size = static_cast<uint32_t>(payload);
+    header->sequence = entry.sequence;
+    header->time_ns = entry.time_ns;
+    header->sim_ns = 0;
+    header->width = 0;
+    header->height = 0;
+    header->stride = 0;
+    header->count = entry.count;
+
+    commitRecord(alignRecord(sizeof(RecordHeader) + payload));
+    detections_written_++;
+}
+
+/**
+ * @brief 在当前分段中预留一条记录的空间
+ * @param payload_size 载荷字节数
+ * @param header 输出：记录头位置
+ * @return 载荷写入位置；记录超过分段容量或无法换段时返回nullptr
+ */
+uint8_t *FrameRecorder::reserveRecord(size_t payload_size, RecordHeader *&header)
+{
+    const size_t record_size = alignRecord(sizeof(RecordHeader) + payload_size);
+    if (record_size > config_.segment_bytes - sizeof(RecordSegmentHeader))
+    {
+        return nullptr;
+    }
+
+    if (!current_.valid() || current_.header()->used_bytes + record_size > current_.capacity)
+    {
+        if (!rotateSegment())
+        {
+            return nullptr;
+        }
+    }
+
+    uint8_t *record = current_.base + current_.header()->used_bytes;
+    std::memset(record, 0, sizeof(RecordHeader));
+    header = reinterpret_cast<RecordHeader *>(record);
+    return record + sizeof(RecordHeader);
+}
+
+// 提交记录：记录内容写完后才推进有效长度（读取方据此判断记录是否完整）
+void FrameRecorder::commitRecord(size_t record_size)
+{
+    RecordSegmentHeader *header = current_.header();
+    header->record_count++;
+    __atomic_store_n(&header->used_bytes, header->used_bytes + record_size, __ATOMIC_RELEASE);
+    bytes_written_ += record_size;
+}
+
+/**
+ * @brief 创建、预分配并映射一个分段文件
+ * @param index 分段序号
+ * @param segment 输出分段
+ * @return 成功返回true
+ */
+bool FrameRecorder::openSegment(uint64_t index, Segment &segment)
+{
+    const std::string path = (fs::path(session_dir_) / segmentName(index)).string();
+    const size_t capacity = config_.segment_bytes;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "无法创建录像分段 " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // 预先分配磁盘空间，写入时不再因扩展文件而阻塞；文件系统不支持时退回 ftruncate
+    const int rc = posix_fallocate(fd, 0, capacity); // 返回错误码，不设置 errno
+    if (rc != 0 && ftruncate(fd, capacity) != 0)
+    {
+        std::cerr << "无法分配录像分段 " << path << ": " << std::strerror(rc) << " (ftruncate: " << std::strerror(errno) << ")" << std::endl;
+        ::close(fd);
+        ::unlink(path.c_str());
+        return false;
+    }
+
+    void *base = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        std::cerr << "无法映射录像分段 " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        ::unlink(path.c_str());
+        return false;
+    }
+    madvise(base, capacity, MADV_SEQUENTIAL);
+
+    segment.fd = fd;
+    segment.base = static_cast<uint8_t *>(base);
+    segment.capacity = capacity;
+    segment.index = index;
+    segment.path = path;
+
+    RecordSegmentHeader *header = segment.header();
+    std::memset(header, 0, sizeof(RecordSegmentHeader));
+    std::memcpy(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header->version = SEGMENT_VERSION;
+    header->header_size = sizeof(RecordSegmentHeader);
+    header->segment_index = index;
+    header->capacity = capacity;
+    header->record_count = 0;
+    header->used_bytes = sizeof(RecordSegmentHeader);
+    return true;
+}
+
+/**
+ * @brief 关闭分段
+ * @param segment 分段
+ * @param keep true：截断到有效长度后保留；false：删除文件
+ */
+void FrameRecorder::closeSegment(Segment &segment, bool keep)
+{
+    const size_t used = segment.header()->used_bytes;
+    if (keep)
+    {
+        msync(segment.base, used, MS_ASYNC);
+    }
+    munmap(segment.base, segment.capacity);
+
+    if (keep)
+    {
+        if (ftruncate(segment.fd, used) != 0)
+        {
+            std::cerr << "录像分段截断失败 " << segment.path << ": " << std::strerror(errno) << std::endl;
+        }
+        ::close(segment.fd);
+        finished_.push_back(segment.path);
+    }
+    else
+    {
+        ::close(segment.fd);
+        ::unlink(segment.path.c_str());
+    }
+    segment = Segment();
+}
+
+/**
+ * @brief 切换到下一个分段
+ * @return 成功返回true
+ *
+ * 下一个分段在上一次换段时已经创建好，这里只交换指针，然后立即准备再下一个分段。
+ * 超过 max_segments 时删除最旧的分段，保留最近一段时间的录像。
+ */
+bool FrameRecorder::rotateSegment()
+{
+    uint64_t next_index = 0;
+    if (current_.valid())
+    {
+        next_index = current_.index + 1;
+        closeSegment(current_, true);
+    }
+
+    if (spare_.valid())
+    {
+        current_ = spare_;
+        spare_ = Segment();
+    }
+    else if (!openSegment(next_index, current_))
+    {
+        return false;
+    }
+
+    openSegment(current_.index + 1, spare_);
+
+    while (config_.max_segments > 0 && finished_.size() + 1 > config_.max_segments)
+    {
+        ::unlink(finished_.front().c_str());
+        finished_.erase(finished_.begin());
+    }
+    return true;
+}
+
+FrameRecordReader::~FrameRecordReader()
+{
+    close();
+}
+
+/**
+ * @brief 打开录像会话目录，只读映射其中的全部分段文件
+ * @param session_dir 会话目录
+ * @return 至少有一个有效分段时返回true
+ */
+bool FrameRecordReader::open(const std::string &session_dir)
+{
+    close();
+
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(session_dir, ec))
+    {
+        if (entry.is_regular_file() && isSegmentFile(entry.path()))
+        {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const fs::path &file : files)
+    {
+        int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RecordSegmentHeader))
+        {
+            ::close(fd);
+            continue;
+        }
+
+        void *base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // 映射建立后即可关闭文件描述符
+        if (base == MAP_FAILED)
+        {
+            continue;
+        }
+
+        const RecordSegmentHeader *header = static_cast<const RecordSegmentHeader *>(base);
+        if (std::memcmp(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 || header->version != SEGMENT_VERSION)
+        {
+            std::cerr << "不是有效的录像分段: " << file << std::endl;
+            munmap(base, st.st_size);
+            continue;
+        }
+
+        MappedSegment segment;
+        segment.base = static_cast<const uint8_t *>(base);
+        segment.size = st.st_size;
+        segment.used = std::min<size_t>(__atomic_load_n(&header->used_bytes, __ATOMIC_ACQUIRE), segment.size);
+        segment.offset = header->header_size;
+        segments_.push_back(segment);
+    }
+
+    current_ = 0;
+    return !segments_.empty();
+}
+
+// 解除全部映射
+void FrameRecordReader::close()
+{
+    for (MappedSegment &segment : segments_)
+    {
+        munmap(const_cast<uint8_t *>(segment.base), segment.size);
+    }
+    segments_.clear();
+    current_ = 0;
+}
+
+/**
+ * @brief 读取下一条记录
+ * @param view 输出：记录视图（指向映射内存）
+ * @return 全部读完返回false；记录头与载荷大小不符（录像损坏）时也返回false
+ */
+bool FrameRecordReader::next(RecordView &view)
+{
+    while (current_ < segments_.size())
+    {
+        MappedSegment &segment = segments_[current_];
+        if (segment.offset + sizeof(RecordHeader) > segment.used)
+        {
+            current_++;
+            continue;
+        }
+
+        const RecordHeader *header = reinterpret_cast<const RecordHeader *>(segment.base + segment.offset);
+        const size_t record_size = alignRecord(sizeof(RecordHeader) + header->payload_size);
+        if (segment.offset + record_size > segment.used)
+        {
+            current_++; // 记录不完整（录像中断），跳到下一个分段
+            continue;
+        }
+        segment.offset += record_size;
+
+        const uint8_t *payload = reinterpret_cast<const uint8_t *>(header + 1);
+        view = RecordView();
+        view.header = header;
+        if (header->type == static_cast<uint32_t>(RecordType::FRAME))
+        {
+            // 图像视图直接建立在映射内存上：尺寸必须落在本条记录的载荷内，否则会越界读取
+            if (header->width == 0 || header->height == 0 || header->stride < header->width ||
+                static_cast<uint64_t>(header->height) * header->stride > header->payload_size)
+            {
+                std::cerr << "录像帧记录损坏: " << header->width << "x" << header->height << " 步长 " << header->stride
+                          << "，载荷 " << header->payload_size << " 字节" << std::endl;
+                return false;
+            }
+            view.type = RecordType::FRAME;
+            view.gray = cv::Mat(header->height, header->width, CV_8UC1, const_cast<uint8_t *>(payload), header->stride);
+            return true;
+        }
+        if (header->type == static_cast<uint32_t>(RecordType::DETECTION))
+        {
+            if (static_cast<uint64_t>(header->count) * sizeof(RecordedTag) > header->payload_size)
+            {
+                std::cerr << "录像检测记录损坏: " << header->count << " 个标签，载荷 " << header->payload_size << " 字节" << std::endl;
+                return false;
+            }
+            view.type = RecordType::DETECTION;
+            view.tags = reinterpret_cast<const RecordedTag *>(payload);
+            view.tag_count = header->count;
+            return true;
+        }
+        // 未知类型的记录直接跳过
+    }
+    return false;
+}
+
+// 回到第一条记录
+void FrameRecordReader::rewind()
+{
+    for (MappedSegment &segment : segments_)
+    {
+        segment.offset = reinterpret_cast<const RecordSegmentHeader *>(segment.base)->header_size;
+    }
+    current_ = 0;
+}
+
+/**
+ * @brief 判断路径是否为录像会话目录（包含分段文件）
+ */
+bool FrameRecordReader::isRecording(const std::string &path)
+{
+    std::error_code ec;
+    if (!fs::is_directory(path, ec))
+    {
+        return false;
+    }
+    for (const auto &entry : fs::directory_iterator(path, ec))
+    {
+        if (entry.is_regular_file() && isSegmentFile(entry.path()))
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,218 @@
+#include "landing_pad.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // 两点距离
+    float distance(const cv::Point2f &a, const cv::Point2f &b)
+    {
+        const cv::Point2f d = a - b;
+        return std::sqrt(d.x * d.x + d.y * d.y);
+    }
+}
+
+// 设置着陆板布局
+void LandingPad::setTags(const std::vector<PadTag> &tags)
+{
+    tags_ = tags;
+    reset();
+}
+
+// 查找标签
+const PadTag *LandingPad::find(int id) const
+{
+    for (const PadTag &tag : tags_)
+    {
+        if (tag.id == id)
+        {
+            return &tag;
+        }
+    }
+    return nullptr;
+}
+
+// 设置标签选择参数
+void LandingPad::setSelectParams(const PadSelectParams &params)
+{
+    params_ = params;
+}
+
+// 清除上一次选择
+void LandingPad::reset()
+{
+    last_id_ = -1;
+}
+
+/**
+ * @brief 从文件加载着陆板布局
+ * @param path YAML/JSON 文件路径，格式：
+ *   tags:
+ *     - { id: 0, size: 0.60, x: 0.0, y: 0.0 }
+ *     - { id: 1, size: 0.08, x: 0.0, y: 0.0 }
+ *   min_side_px: 16      # 可选，其余选择参数同名
+ * @return 加载成功返回true（失败时保持原布局）
+ */
+bool LandingPad::load(const std::string &path)
+{
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened())
+    {
+        std::cerr << "无法打开着陆板布局文件: " << path << std::endl;
+        return false;
+    }
+
+    const cv::FileNode nodes = fs["tags"];
+    if (!nodes.isSeq() || nodes.size() == 0)
+    {
+        std::cerr << "着陆板布局文件缺少 tags 列表: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<PadTag> tags;
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const cv::FileNode node = nodes[static_cast<int>(i)];
+        PadTag tag;
+        tag.id = static_cast<int>(node["id"]);
+        tag.size_m = static_cast<float>(node["size"]);
+        tag.offset_x_m = node["x"].empty() ? 0.0f : static_cast<float>(node["x"]);
+        tag.offset_y_m = node["y"].empty() ? 0.0f : static_cast<float>(node["y"]);
+        const bool duplicate = std::any_of(tags.begin(), tags.end(), [&tag](const PadTag &other)
+                                           { return other.id == tag.id; });
+        if (tag.size_m <= 0.0f || duplicate)
+        {
+            std::cerr << "着陆板标签 " << tag.id << " 的尺寸无效或ID重复" << std::endl;
+            return false;
+        }
+        tags.push_back(tag);
+    }
+
+    PadSelectParams params = params_;
+    const auto read = [&fs](const char *key, float &value)
+    {
+        const cv::FileNode node = fs[key];
+        if (!node.empty())
+        {
+            value = static_cast<float>(node);
+        }
+    };
+    read("min_side_px", params.min_side_px);
+    read("max_side_ratio", params.max_side_ratio);
+    read("edge_margin_px", params.edge_margin_px);
+    read("switch_ratio", params.switch_ratio);
+
+    setTags(tags);
+    setSelectParams(params);
+    return true;
+}
+
+/**
+ * @brief 标签评分（越大越好）
+ * @param det 检测结果
+ * @param tag 对应的着陆板标签
+ * @param frame_size 图像尺寸
+ * @param side_px 输出平均边长(像素)
+ *
+ * 以像素边长为基础（角点定位误差相对标签尺寸越小越好），对过小、过大、贴边、有纠错位的标签降权，
+ * 并按偏移换算的误差放大（偏移越大，朝向和尺度误差被放大得越多）折算。
+ */
+float LandingPad::score(const TagDetection &det, const PadTag &tag, const cv::Size &frame_size, float &side_px) const
+{
+    side_px = 0.0f;
+    bool in_frame = true;
+    for (int k = 0; k < 4; ++k)
+    {
+        const cv::Point2f &p = det.corners[k];
+        side_px += distance(p, det.corners[(k + 1) % 4]) * 0.25f;
+        in_frame = in_frame && p.x >= params_.edge_margin_px && p.y >= params_.edge_margin_px &&
+                   p.x < frame_size.width - params_.edge_margin_px && p.y < frame_size.height - params_.edge_margin_px;
+    }
+
+    const float max_side = params_.max_side_ratio * std::min(frame_size.width, frame_size.height);
+    float value = side_px;
+    if (side_px > max_side)
+    {
+        value = max_side * max_side / side_px; // 过大：越大越可能即将出画
+    }
+    if (side_px < params_.min_side_px)
+    {
+        value *= 0.1f;
+    }
+    if (!in_frame)
+    {
+        value *= 0.1f;
+    }
+    if (det.hamming > 0)
+    {
+        value *= 0.5f;
+    }
+    if (tag.size_m > 0.0f)
+    {
+        const float offset = std::sqrt(tag.offset_x_m * tag.offset_x_m + tag.offset_y_m * tag.offset_y_m);
+        value /= 1.0f + 0.5f * offset / tag.size_m;
+    }
+    return value;
+}
+
+cv::Point2f LandingPad::center(const TagDetection &det) const
+{
+    const PadTag *tag = find(det.id);
+    if (tag == nullptr || tag->size_m <= 0.0f)
+    {
+        return det.center;
+    }
+
+    // 标签坐标轴的半边长向量：x 轴沿 p0→p1（与 p3→p2 平均），y 轴沿 p3→p0（与 p2→p1 平均）
+    const cv::Point2f half_x = ((det.corners[1] - det.corners[0]) + (det.corners[2] - det.corners[3])) * 0.25f;
+    const cv::Point2f half_y = ((det.corners[0] - det.corners[3]) + (det.corners[1] - det.corners[2])) * 0.25f;
+    const float half_size = tag->size_m * 0.5f;
+    return det.center - (half_x * (tag->offset_x_m / half_size) + half_y * (tag->offset_y_m / half_size));
+}
+
+PadEstimate LandingPad::select(const std::vector<TagDetection> &detections, const cv::Size &frame_size)
+{
+    PadEstimate best;
+    PadEstimate previous; // 上一帧所选标签在本帧的估计（用于切换迟滞）
+
+    for (size_t i = 0; i < detections.size(); ++i)
+    {
+        const TagDetection &det = detections[i];
+
+        // 未配置布局时每个标签都视为位于板中心
+        PadTag single;
+        single.id = det.id;
+        const PadTag *tag = tags_.empty() ? &single : find(det.id);
+        if (tag == nullptr)
+        {
+            continue; // 不属于着陆板的标签
+        }
+
+        PadEstimate candidate;
+        candidate.valid = true;
+        candidate.index = static_cast<int>(i);
+        candidate.id = det.id;
+        candidate.score = score(det, *tag, frame_size, candidate.side_px);
+        candidate.px_per_m = tag->size_m > 0.0f ? candidate.side_px / tag->size_m : 0.0f;
+        candidate.center = center(det);
+
+        if (!best.valid || candidate.score > best.score)
+        {
+            best = candidate;
+        }
+        if (det.id == last_id_ && (!previous.valid || candidate.score > previous.score))
+        {
+            previous = candidate;
+        }
+    }
+
+    // 上一帧的标签仍然可用且没有被明显超过时继续使用
+    if (previous.valid && best.id != previous.id && best.score < previous.score * params_.switch_ratio)
+    {
+        best = previous;
+    }
+    last_id_ = best.valid ? best.id : -1;
+    return best;
+}
@@ -1,5 +1,6 @@
 #include "landing_state_machine.hpp"
 #include "flight_procedure.hpp"
+#include "offboard_session.hpp"
 #include "user_task.hpp"
 
 #include <cerrno>
@@ -31,8 +32,12 @@ int LandingStateMachine::StartStateMachine()
         circle_position = m_current_position; // 记录当前位置为降落起始点
         circle_yaw_deg = m_current_yaw_deg;   // 记录当前偏航角度
 
-        state_ = LandingState::WAITING; // 设置为等待状态
-        start_landing_flag_ = true;     // 标记已启动降落流程
+        state_ = LandingState::WAITING;          // 设置为等待状态
+        start_landing_flag_ = true;              // 标记已启动降落流程
+        circle_first_entry_ = true;              // 清除上一次流程遗留的阶段计时
+        landing_timer_started_ = false;
+        land_future_ = std::shared_future<ActionOutcome>();
+        offboard_session::Instance()->release(); // 清除上一次的模式丢失状态，首个设定点时重新进入offboard
         std::cout << "降落识别状态机已启动，初始位置已记录" << std::endl;
         mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, "降落识别状态机已启动，初始位置已记录");
 
@@ -41,6 +46,20 @@ int LandingStateMachine::StartStateMachine()
     return 1;
 }
 
+/**
+ * @brief 终止降落流程
+ * 用于任务被新命令取消；offboard会话继续发送最后的设定点（速度设定点超时后为悬停），由后续命令切换模式
+ */
+void LandingStateMachine::abort()
+{
+    if (start_landing_flag_)
+    {
+        std::cout << "降落识别状态机已终止" << std::endl;
+    }
+    state_ = LandingState::IDLE;
+    start_landing_flag_ = false;
+}
+
 /**
  * @brief 状态机主更新函数
  * @param current_altitude 当前高度
@@ -61,6 +80,16 @@ void LandingStateMachine::updateState(Mavsdk_members &mavsdk)
         }
     }
 
+    // offboard模式被切走（遥控器接管或飞控失效保护）时终止降落流程，不再争夺控制权
+    if (start_landing_flag_ && offboard_session::Instance()->state() == OffboardState::LOST)
+    {
+        state_ = LandingState::IDLE;
+        start_landing_flag_ = false;
+        std::cout << "offboard模式已丢失，降落识别状态机已终止" << std::endl;
+        mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, "offboard模式已丢失，降落识别状态机已终止");
+        return;
+    }
+
     // 如果降落标志已启动，根据当前状态执行对应的状态处理
     if (start_landing_flag_)
     {
@@ -100,8 +129,8 @@ void LandingStateMachine::waitingState(Mavsdk_members &mavsdk)
     // 检查是否已等待5秒
     if (std::chrono::duration_cast<std::chrono::duration<double>>(getCurrentTime() - waiting_state_time_).count() >= 5.0)
     {
-        // 根据地标检测次数决定下一状态
-        if (landmark_detection_count_ > 30)
+        // 根据地标检测次数占比决定下一状态
+        if (landmark_check_count_ > 0 && landmark_detection_count_ > landmark_check_count_ * DETECTION_RATIO)
         {
             state_ = LandingState::ADJUST_POSITION; // 检测次数足够，切换到位置调整状态
         }
@@ -110,10 +139,12 @@ void LandingStateMachine::waitingState(Mavsdk_members &mavsdk)
             state_ = LandingState::CIRCLE; // 切换到绕圈搜索状态
         }
         landmark_detection_count_ = 0; // 重置检测计数
+        landmark_check_count_ = 0;
     }
     else
     {
         // 若检测到地标则增加检测计数
+        landmark_check_count_++;
         if (m_landmark.iffind)
         {
             landmark_detection_count_++; // 地标可见，计数增加
@@ -176,8 +207,11 @@ void LandingStateMachine::adjustPositionState(Mavsdk_members &mavsdk)
         // 处理地标可见的情况
         if (m_landmark.iffind)
         {
-            // 根据误差与容忍度的关系决定是下降还是水平移动
-            if (std::abs(m_landmark.err_x) < position_tolerance && std::abs(m_landmark.err_y) < position_tolerance)
+            // 根据误差与容忍度的关系决定是下降还是水平移动（有米制位置时按米判断，否则按分层的像素容忍度）
+            const bool centered = m_landmark.pose_valid
+                                      ? std::abs(m_landmark.err_x_m) < POSITION_TOLERANCE_M && std::abs(m_landmark.err_y_m) < POSITION_TOLERANCE_M
+                                      : std::abs(m_landmark.err_x) < position_tolerance && std::abs(m_landmark.err_y) < position_tolerance;
+            if (centered)
             {
                 // 误差在容忍度内，开始下降
                 offboard_flight_body_velocity(mavsdk, m_pid_out.x, m_pid_out.y, descent_speed, 0.0);
@@ -228,19 +262,17 @@ void LandingStateMachine::circleState(Mavsdk_members &mavsdk)
     // 当高度大于1.0米时执行绕圈搜索
     if (m_current_altitude > 1.0)
     {
-        static bool first_entry = true;
-        static double start_angle = 0.0;
-        static std::chrono::time_point<std::chrono::system_clock> circle_start_time;
+        const double start_angle = 0.0;
 
         // 首次进入绕圈搜索状态时的初始化
-        if (first_entry)
+        if (circle_first_entry_)
         {
-            circle_start_time = getCurrentTime();
-            first_entry = false;
+            circle_start_time_ = getCurrentTime();
+            circle_first_entry_ = false;
         }
 
         // 计算绕圈时间
-        double elapsed_time = std::chrono::duration_cast<std::chrono::duration<double>>(getCurrentTime() - circle_start_time).count();
+        double elapsed_time = std::chrono::duration_cast<std::chrono::duration<double>>(getCurrentTime() - circle_start_time_).count();
         const double transition_time = 5.0; // 加速阶段持续时间
 
         // 如果处于过渡时间范围内
@@ -280,7 +312,7 @@ void LandingStateMachine::circleState(Mavsdk_members &mavsdk)
         if (m_landmark.iffind)
         {
             state_ = LandingState::ADJUST_POSITION;
-            first_entry = true; // 重置首次进入标志
+            circle_first_entry_ = true; // 重置首次进入标志
         }
     }
     else
@@ -298,18 +330,15 @@ void LandingStateMachine::circleState(Mavsdk_members &mavsdk)
  */
 void LandingStateMachine::landingState(Mavsdk_members &mavsdk)
 {
-    static bool timer_started_ = false;
-    static std::chrono::time_point<std::chrono::system_clock> landing_start_time;
-
     // 首次进入降落状态时记录时间
-    if (!timer_started_)
+    if (!landing_timer_started_)
     {
-        landing_start_time = getCurrentTime();
-        timer_started_ = true;
+        landing_start_time_ = getCurrentTime();
+        landing_timer_started_ = true;
     }
 
     // 高度大于0.5米且降落时间小于5秒时，继续调整降落
-    if (m_current_altitude > 1.0 && std::chrono::duration_cast<std::chrono::duration<double>>(getCurrentTime() - landing_start_time).count() < 5.0)
+    if (m_current_altitude > 1.0 && std::chrono::duration_cast<std::chrono::duration<double>>(getCurrentTime() - landing_start_time_).count() < 5.0)
     {
         // 地标可见时，带位置调整下降
         if (m_landmark.iffind)
@@ -323,9 +352,10 @@ void LandingStateMachine::landingState(Mavsdk_members &mavsdk)
     }
     else // 切换到自动降落模式
     {
-        land_and_disarm(mavsdk);
-        timer_started_ = false;      // 重置计时器标志
-        start_landing_flag_ = false; // 关闭降落标志
+        // 非阻塞：着地后自动上锁，结果由任务引擎的视觉降落步骤等待并报告
+        land_future_ = land_and_disarm(mavsdk);
+        landing_timer_started_ = false; // 重置计时器标志
+        start_landing_flag_ = false;    // 关闭降落标志
     }
 }
 
@@ -1,15 +1,23 @@
+#include "action_executor.hpp"
 #include "coordinate_analysis.hpp"
+#include "event_flags.hpp"
 #include "file_transfer.hpp"
 #include "flight_procedure.hpp"
 #include "fly_mission.hpp"
+#include "frame_recorder.hpp"
 #include "landing_state_machine.hpp"
+#include "latency_histogram.hpp"
 #include "mavsdk_members.hpp"
+#include "mission_task.hpp"
 #include "mqtt_client.hpp"
+#include "offboard_session.hpp"
+#include "periodic_scheduler.hpp"
 #include "pid.hpp"
 #include "telemetry_monitor.hpp"
 #include "user_task.hpp"
 
 #include <chrono>
+#include <cstdlib>
 #include <fcntl.h>
 #include <fstream>
 #include <mutex>
@@ -98,7 +106,70 @@ int main(int argc, char *argv[])
     Telemetry &telemetry = mavsdk.telemetry;       // 获取遥测数据模块引用
     TelemetryMonitor telemetry_monitor(telemetry); // 创建遥测监控器实例
 
+    // Offboard会话：设定点由独立线程按固定频率发送，只在首次发布时请求进入offboard模式；模式被切走时通过MQTT报告
+    OffboardSessionParams offboard_params;
+    offboard_params.rate_hz = 30.0;
+    offboard_session::Instance()->setModeLossCallback([]()
+                                                      { mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, "offboard模式已丢失（遥控器接管或失效保护）"); });
+    offboard_session::Instance()->start(mavsdk.offboard, mavsdk.telemetry, offboard_params);
+
+    // 动作执行器：起飞、降落、上锁在独立线程中按阶段异步执行，控制线程不再等待命令应答
+    action_executor::Instance()->start(mavsdk.action, mavsdk.telemetry);
+
+    // 任务引擎：MQTT命令转换为可组合的非阻塞任务，在用户任务中逐周期推进，任务进展通过MQTT报告
+    task_engine::Instance()->setReporter([](const std::string &text)
+                                         { mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, text); });
+
     /*::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
+    // 飞行录像：设置环境变量 PX4_RECORD_DIR 时录制相机灰度帧和检测结果，用于回放和复现降落问题
+    if (const char *record_dir = std::getenv("PX4_RECORD_DIR"))
+    {
+        RecorderConfig record_config;
+        record_config.directory = record_dir;
+        record_config.max_segments = 32; // 64MB x 32，保留最近约 2GB 录像
+        if (frame_recorder::Instance()->start(record_config))
+        {
+            mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, "录像已开始: " + frame_recorder::Instance()->sessionDirectory());
+        }
+    }
+
+    // 搜索阶段（没有跟踪窗口）启用级联检测：先找候选方块，解码器只在候选区域内运行（须在检测线程启动前设置）
+    CascadeParams cascade_params;
+    cascade_params.enabled = true;
+    tag_tracker::Instance()->setCascade(cascade_params);
+
+    // 帧时间预算：按实测帧周期设定检测预算，跳过过旧的帧，持续超预算时逐级提高降采样倍数
+    tag_tracker::Instance()->setDeadline(DeadlineParams());
+
+    // 光流跟踪：两次完整检测之间用 LK 光流跟踪标签角点，提高测量频率（每5帧完整检测一次，跟踪失败时立即完整检测）
+    FlowTrackingParams flow_params;
+    flow_params.enabled = true;
+    tag_tracker::Instance()->setFlowTracking(flow_params);
+
+    // 嵌套着陆板：设置环境变量 PX4_PAD_LAYOUT 指向布局文件时按各标签尺寸和偏移输出着陆板中心
+    if (const char *pad_layout = std::getenv("PX4_PAD_LAYOUT"))
+    {
+        const bool loaded = tag_tracker::Instance()->loadPadLayout(pad_layout);
+        mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, std::string(loaded ? "着陆板布局已加载: " : "着陆板布局加载失败: ") + pad_layout);
+    }
+
+    // 相机标定：设置环境变量 PX4_CAMERA_CALIB 指向标定文件时对所选标签的角点去畸变，位姿使用标定内参
+    if (const char *camera_calib = std::getenv("PX4_CAMERA_CALIB"))
+    {
+        const bool loaded = tag_tracker::Instance()->loadCalibration(camera_calib);
+        mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, std::string(loaded ? "相机标定已加载: " : "相机标定加载失败: ") + camera_calib);
+    }
+
+    // 米制位姿：已知标签边长时由角点解算着陆板相对飞行器的米制位置，PID 和降落容忍度改用米（与高度无关）
+    // 配置了着陆板布局时按布局中各标签尺寸解算；单标签时由环境变量 PX4_TAG_SIZE_M 给出边长
+    TagPoseParams pose_params;
+    if (const char *tag_size = std::getenv("PX4_TAG_SIZE_M"))
+    {
+        pose_params.tag_size_m = std::atof(tag_size);
+    }
+    tag_tracker::Instance()->setTagPose(pose_params);
+    pid::Instance()->setMetricMode(true);
+
     // 启动Gazebo环境
     tag_tracker::Instance()->GazeboStart(argc, argv);
 
@@ -107,53 +178,121 @@ int main(int argc, char *argv[])
 
     /*::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
 
-    while (running)
+    // 控制周期内的最新数据，供状态日志使用（所有任务在调度线程中依次执行，无需加锁）
+    struct ControlSnapshot
     {
-        Telemetry::PositionNed current_position = telemetry_monitor.getCurrentPosition();    // 获取当前无人机位置(NED坐标系)
-        Telemetry::EulerAngle euler_angle = telemetry_monitor.getCurrentEulerAngles();       // 获取当前欧拉角姿态
-        Telemetry::FlightMode flight_mode = telemetry_monitor.getCurrentFlightMode();        // 获取当前飞行模式
-        Telemetry::RawGps gps_raw = telemetry_monitor.getCurrentRawGps();                    // 获取当前GPS信息
-        float current_relative_altitude_m = telemetry_monitor.getCurrentRelativeAltitudeM(); // 获取当前相对高度
-        float current_distance_sensor_m = telemetry_monitor.getCurrentDistanceSensorM();     // 获取当前距离传感器高度
+        Telemetry::PositionNed current_position{};
+        Telemetry::EulerAngle euler_angle{};
+        Telemetry::FlightMode flight_mode{};
+        Telemetry::RawGps gps_raw{};
+        float current_relative_altitude_m = 0.0f;
+        float current_distance_sensor_m = 0.0f;
+        AprilTagData landmark{};
+        LandingState state_{};
+        PIDOutput PID_out{};
+    } snapshot;
 
-        // AprilTagData landmark = tag_tracker::Instance()->process();                        // 处理AprilTag检测结果
-        // PIDOutput PID_out = pid::Instance()->Output_PID();                                 // 更新PID结果
-        LandingState state_ = landing_state_machine::Instance()->getCurrentStateMachine(); // 输出状态机处于的模式
+    PeriodicScheduler scheduler;
 
-        // pid::Instance()->getLandmark(landmark); // 获取地标检测数据
-        pid::Instance()->PID_update(); // 更新PID控制器状态
+    // 控制任务：遥测 → 视觉结果 → PID → 降落状态机
+    auto control_task = [&]()
+    {
+        snapshot.current_position = telemetry_monitor.getCurrentPosition();                     // 获取当前无人机位置(NED坐标系)
+        snapshot.euler_angle = telemetry_monitor.getCurrentEulerAngles();                       // 获取当前欧拉角姿态
+        snapshot.flight_mode = telemetry_monitor.getCurrentFlightMode();                        // 获取当前飞行模式
+        snapshot.current_relative_altitude_m = telemetry_monitor.getCurrentRelativeAltitudeM(); // 获取当前相对高度
+        const Telemetry::EulerAngle &euler_angle = snapshot.euler_angle;
+
+        tag_tracker::Instance()->setRelativeAltitude(snapshot.current_relative_altitude_m); // 更新视觉检测器档位选择所用的高度
+        tag_tracker::Instance()->setAttitude({euler_angle.roll_deg, euler_angle.pitch_deg, euler_angle.yaw_deg}); // 更新位姿解算的姿态补偿
+
+        snapshot.landmark = tag_tracker::Instance()->process();                        // 获取检测线程最新的AprilTag检测结果（带采集时间戳）
+        snapshot.state_ = landing_state_machine::Instance()->getCurrentStateMachine(); // 输出状态机处于的模式
+
+        pid::Instance()->getLandmark(snapshot.landmark);  // 获取地标检测数据
+        pid::Instance()->PID_update();                    // 更新PID控制器状态
+        snapshot.PID_out = pid::Instance()->Output_PID(); // 本周期PID结果
 
         // 降落状态机数据更新
-        // landing_state_machine::Instance()->setRelevantData(landmark, PID_out, current_position, euler_angle.yaw_deg, current_relative_altitude_m);
+        landing_state_machine::Instance()->setRelevantData(snapshot.landmark, snapshot.PID_out, snapshot.current_position, euler_angle.yaw_deg, snapshot.current_relative_altitude_m);
         landing_state_machine::Instance()->updateState(mavsdk);
+    };
+
+    // 状态日志
+    auto status_task = [&]()
+    {
+        snapshot.gps_raw = telemetry_monitor.getCurrentRawGps();                            // 获取当前GPS信息
+        snapshot.current_distance_sensor_m = telemetry_monitor.getCurrentDistanceSensorM(); // 获取当前距离传感器高度
+        const AprilTagData &landmark = snapshot.landmark;
+        const PIDOutput &PID_out = snapshot.PID_out;
+        const Telemetry::EulerAngle &euler_angle = snapshot.euler_angle;
+        const Telemetry::PositionNed &current_position = snapshot.current_position;
+
+        // 发送的消息 - 字符串
+        std::string logMessage = "Mode: " + telemetry_monitor.flight_mode_str(snapshot.flight_mode) + ", state : " + landing_state_machine::Instance()->landingStateToString(snapshot.state_) + "\n";
+        logMessage += "Beidou:(N: " + std::to_string(beidou_data.latitude) + ", E: " + std::to_string(beidou_data.longitude) + ")" + "\n";
+        logMessage += "Landmark:(x: " + std::to_string(landmark.x) + ", y: " + std::to_string(landmark.y) + ")" + "\n";
+        logMessage += "err:(x: " + std::to_string(landmark.err_x) + ", y: " + std::to_string(landmark.err_y) + ")" + "\n";
+        if (landmark.pose_valid)
+        {
+            logMessage += "err_m:(x: " + std::to_string(landmark.err_x_m) + ", y: " + std::to_string(landmark.err_y_m) + ", h: " + std::to_string(landmark.height_m) + ")" + "\n";
+        }
+        logMessage += "PID:(x: " + std::to_string(PID_out.x) + ", y: " + std::to_string(PID_out.y) + ")" + "\n";
+        logMessage += "Euler:(yaw: " + std::to_string(euler_angle.yaw_deg) + ", pitch: " + std::to_string(euler_angle.pitch_deg) + ", roll: " + std::to_string(euler_angle.roll_deg) + ")" + "\n";
+        logMessage += "Position:(x: " + std::to_string(current_position.north_m) + ", y: " + std::to_string(current_position.east_m) + ", z: " + std::to_string(-current_position.down_m) + ")" + "\n";
+        logMessage += "GPS:(x: " + std::to_string(snapshot.gps_raw.latitude_deg) + ", y: " + std::to_string(snapshot.gps_raw.longitude_deg) + ")" + "\n";
+        logMessage += "distance: " + std::to_string(snapshot.current_distance_sensor_m) + "\n";
+
+        DetectorProfile profile = tag_tracker::Instance()->activeProfile(); // 当前视觉检测器档位
+        logMessage += "Vision: " + profile.name + "(decimate: " + std::to_string(profile.quad_decimate) + ", sigma: " + std::to_string(profile.quad_sigma) + ", threads: " + std::to_string(profile.nthreads) + ", reused frames: " + std::to_string(tag_tracker::Instance()->reusedFrames()) + ", tracked frames: " + std::to_string(tag_tracker::Instance()->trackedFrames()) + ")" + "\n";
 
-        userTaskProcedure(mavsdk);
+        logMessage += pipeline_latency::Instance()->report() + "\n"; // 视觉链路各阶段延迟（本周期统计后清零）
 
-        /*:::::::::::::::::::::::::::::::::::::::::::::::: 日志（每秒一次） ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
-        static auto lastWriteTime = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - lastWriteTime).count() >= 1)
+        DeadlineStats deadline = tag_tracker::Instance()->deadlineStats(); // 检测线程帧率与时间预算（累计计数）
+        logMessage += "Deadline: fps " + std::to_string(deadline.effective_fps) + ", period " + std::to_string(deadline.period_ms) + " ms, budget " + std::to_string(deadline.budget_ms) + " ms, detect " + std::to_string(deadline.detect_ms) + " ms, level " + std::to_string(deadline.level) + ", light " + std::to_string(deadline.light_frames) + ", skipped " + std::to_string(deadline.skipped) + ", overruns " + std::to_string(deadline.overruns) + "\n";
+
+        CascadeStats cascade = tag_tracker::Instance()->cascadeStats(); // 级联检测第一级命中/漏检统计（累计）
+        logMessage += "Cascade: frames " + std::to_string(cascade.frames) + ", rejected " + std::to_string(cascade.rejected) + ", regions " + std::to_string(cascade.regions) + " (hit " + std::to_string(cascade.region_hits) + ", miss " + std::to_string(cascade.region_misses) + "), fallbacks " + std::to_string(cascade.fallbacks) + ", audit misses " + std::to_string(cascade.audit_misses) + "/" + std::to_string(cascade.audits) + "\n";
+
+        if (frame_recorder::Instance()->recording())
         {
-            // 发送的消息 - 字符串
-            std::string logMessage = "Mode: " + telemetry_monitor.flight_mode_str(flight_mode) + ", state : " + landing_state_machine::Instance()->landingStateToString(state_) + "\n";
-            logMessage += "Beidou:(N: " + std::to_string(beidou_data.latitude) + ", E: " + std::to_string(beidou_data.longitude) + ")" + "\n";
-            // logMessage += "Landmark:(x: " + std::to_string(landmark.x) + ", y: " + std::to_string(landmark.y) + ")" + "\n";
-            // logMessage += "err:(x: " + std::to_string(landmark.err_x) + ", y: " + std::to_string(landmark.err_y) + ")" + "\n";
-            // logMessage += "PID:(x: " + std::to_string(PID_out.x) + ", y: " + std::to_string(PID_out.y) + ")" + "\n";
-            logMessage += "Euler:(yaw: " + std::to_string(euler_angle.yaw_deg) + ", pitch: " + std::to_string(euler_angle.pitch_deg) + ", roll: " + std::to_string(euler_angle.roll_deg) + ")" + "\n";
-            logMessage += "Position:(x: " + std::to_string(current_position.north_m) + ", y: " + std::to_string(current_position.east_m) + ", z: " + std::to_string(-current_position.down_m) + ")" + "\n";
-            logMessage += "GPS:(x: " + std::to_string(gps_raw.latitude_deg) + ", y: " + std::to_string(gps_raw.longitude_deg) + ")" + "\n";
-            logMessage += "distance: " + std::to_string(current_distance_sensor_m) + "\n";
-
-            mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, logMessage); // 发送MQTT消息 发送到flight_tx主题
-
-            lastWriteTime = std::chrono::steady_clock::now(); // 更新时间
+            logMessage += "Record: frames " + std::to_string(frame_recorder::Instance()->framesWritten()) + " (dropped " + std::to_string(frame_recorder::Instance()->framesDropped()) + "), " + std::to_string(frame_recorder::Instance()->bytesWritten() >> 20) + " MB" + "\n";
         }
-        /*:::::::::::::::::::::::::::::::::::::::::::::::: 日志（每秒一次） ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 间歇休眠减少CPU占用(10Hz)
+        logMessage += scheduler.report() + "\n"; // 控制调度各任务执行耗时与错过周期（最大值本周期统计后清零）
+
+        OffboardStats offboard = offboard_session::Instance()->stats(); // offboard会话（累计）
+        logMessage += "Offboard: " + OffboardSession::stateToString(offboard.state) + ", published " + std::to_string(offboard.published) + ", sent " + std::to_string(offboard.sent) + " (stale " + std::to_string(offboard.stale) + "), starts " + std::to_string(offboard.start_attempts) + " (failed " + std::to_string(offboard.start_failures) + "), mode losses " + std::to_string(offboard.mode_losses) + "\n";
+
+        logMessage += "Action: " + ActionExecutor::phaseToString(action_executor::Instance()->phase()) + "\n"; // 起飞/降落动作执行阶段
+        logMessage += "Task: " + task_engine::Instance()->current() + "\n";                                    // 当前任务及步骤
+
+        EventStats events = control_events::Instance()->stats(); // 控制线程唤醒事件（累计）
+        logMessage += "Events: posted " + std::to_string(events.posted) + ", wakeups " + std::to_string(events.wakeups) + ", coalesced " + std::to_string(events.coalesced) + "\n";
+
+        mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, logMessage); // 发送MQTT消息 发送到flight_tx主题
+    };
+
+    // 控制由新检测结果和遥测更新触发（最高50Hz），没有事件时按10Hz兜底执行（状态机计时）；
+    // 用户任务由MQTT命令触发，没有命令时按10Hz推进任务引擎中正在执行的任务
+    scheduler.setEventSource(control_events::Instance());
+    scheduler.addEventTask("control", 10.0, 50.0, 3, EVENT_DETECTION | EVENT_TELEMETRY, control_task);
+    scheduler.addEventTask("user_task", 10.0, 20.0, 2, EVENT_COMMAND, [&mavsdk]()
+                           { userTaskProcedure(mavsdk); });
+    scheduler.addTask("status", 1.0, 1, status_task); // 状态日志(1Hz，最低优先级)
+
+    // 实时调度：设置环境变量 PX4_RT_PRIORITY 时把控制线程设为 SCHED_FIFO（需要 CAP_SYS_NICE 或 root）
+    if (const char *rt_priority = std::getenv("PX4_RT_PRIORITY"))
+    {
+        PeriodicScheduler::setRealtimePriority(std::atoi(rt_priority));
     }
 
-    // tag_tracker::Instance()->stop(); // 停止AprilTag跟踪器
+    scheduler.run(running); // 按绝对时刻周期或事件执行各任务，直到 running 变为 false
+
+    tag_tracker::Instance()->stop(); // 停止AprilTag跟踪器
+    offboard_session::Instance()->stop(); // 停止设定点发送线程
+    action_executor::Instance()->stop(); // 停止动作执行线程
+    frame_recorder::Instance()->stop(); // 写完剩余录像并关闭文件
 
     return 0;
 }
\ No newline at end of file
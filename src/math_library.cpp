@@ -88,6 +88,193 @@ namespace Filter
         p_ = 1.0; // 重置误差协方差
     }
 
+    /*::::::::::::::::::::::::::::::::::::::::::::::::::: 二维匀速卡尔曼滤波器实现 :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
+    /**
+     * 二维匀速卡尔曼滤波器构造函数
+     * @param accel_noise 加速度噪声标准差（单位/s^2），越大越相信测量、对机动响应越快
+     * @param measurement_noise 测量噪声标准差（单位与测量一致）
+     * @param initial_velocity_std 初始化时速度的标准差（单位/s）
+     *
+     * 过程噪声采用连续白噪声加速度模型，每个轴：
+     *   Q = q·[dt³/3, dt²/2; dt²/2, dt]
+     */
+    ConstantVelocityKalman2D::ConstantVelocityKalman2D(double accel_noise, double measurement_noise, double initial_velocity_std)
+        : q_(accel_noise * accel_noise),
+          r_(measurement_noise * measurement_noise),
+          v0_var_(initial_velocity_std * initial_velocity_std),
+          gate_(13.8), // 2自由度卡方分布 99.9% 分位
+          initialized_(false),
+          last_update_ns_(0),
+          state_{}
+    {
+    }
+
+    // 用第一次测量初始化：位置取测量值，速度为0
+    void ConstantVelocityKalman2D::initialize(double mx, double my, int64_t t_ns)
+    {
+        state_ = State{};
+        state_.x[0] = mx;
+        state_.x[1] = my;
+        state_.P[0][0] = r_;
+        state_.P[1][1] = r_;
+        state_.P[2][2] = v0_var_;
+        state_.P[3][3] = v0_var_;
+        last_update_ns_ = t_ns;
+        initialized_ = true;
+    }
+
+    /**
+     * 匀速模型时间更新
+     *   x' = F·x,  P' = F·P·Fᵀ + Q,  F = [I, dt·I; 0, I]
+     */
+    void ConstantVelocityKalman2D::propagate(State &s, double dt) const
+    {
+        if (dt <= 0.0)
+        {
+            return;
+        }
+
+        s.x[0] += s.x[2] * dt;
+        s.x[1] += s.x[3] * dt;
+
+        // F·P·Fᵀ：位置行/列加上 dt 倍的速度行/列
+        double P[4][4];
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                P[i][j] = s.P[i][j];
+            }
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            P[0][j] += dt * s.P[2][j];
+            P[1][j] += dt * s.P[3][j];
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            s.P[i][0] = P[i][0] + dt * P[i][2];
+            s.P[i][1] = P[i][1] + dt * P[i][3];
+            s.P[i][2] = P[i][2];
+            s.P[i][3] = P[i][3];
+        }
+
+        const double dt2 = dt * dt;
+        const double q_pp = q_ * dt2 * dt / 3.0;
+        const double q_pv = q_ * dt2 / 2.0;
+        const double q_vv = q_ * dt;
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            s.P[axis][axis] += q_pp;
+            s.P[axis][axis + 2] += q_pv;
+            s.P[axis + 2][axis] += q_pv;
+            s.P[axis + 2][axis + 2] += q_vv;
+        }
+    }
+
+    /**
+     * 融合一次带时间戳的测量
+     * @param mx 测量 x
+     * @param my 测量 y
+     * @param t_ns 测量时刻（纳秒，单调时钟）；早于上一次测量的数据直接丢弃
+     * @return true：正常融合；false：新息超出门限（目标跳变），已用该测量重新初始化
+     */
+    bool ConstantVelocityKalman2D::update(double mx, double my, int64_t t_ns)
+    {
+        if (!initialized_)
+        {
+            initialize(mx, my, t_ns);
+            return true;
+        }
+        if (t_ns < last_update_ns_)
+        {
+            return true; // 乱序测量
+        }
+
+        propagate(state_, (t_ns - last_update_ns_) * 1e-9);
+        last_update_ns_ = t_ns;
+
+        // 新息及其协方差 S = H·P·Hᵀ + R（H 取位置分量）
+        const double y0 = mx - state_.x[0];
+        const double y1 = my - state_.x[1];
+        const double s00 = state_.P[0][0] + r_;
+        const double s01 = state_.P[0][1];
+        const double s11 = state_.P[1][1] + r_;
+        const double det = s00 * s11 - s01 * s01;
+        if (det <= 0.0)
+        {
+            initialize(mx, my, t_ns);
+            return false;
+        }
+        const double i00 = s11 / det;
+        const double i01 = -s01 / det;
+        const double i11 = s00 / det;
+
+        // 马氏距离检验：超过门限说明目标跳变（如换成另一个标签），直接重新初始化
+        const double d2 = y0 * (i00 * y0 + i01 * y1) + y1 * (i01 * y0 + i11 * y1);
+        if (gate_ > 0.0 && d2 > gate_)
+        {
+            initialize(mx, my, t_ns);
+            return false;
+        }
+
+        // 增益 K = P·Hᵀ·S⁻¹（4x2）
+        double K[4][2];
+        for (int i = 0; i < 4; ++i)
+        {
+            K[i][0] = state_.P[i][0] * i00 + state_.P[i][1] * i01;
+            K[i][1] = state_.P[i][0] * i01 + state_.P[i][1] * i11;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            state_.x[i] += K[i][0] * y0 + K[i][1] * y1;
+        }
+
+        // P = (I - K·H)·P，并保持对称
+        double P[4][4];
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                P[i][j] = state_.P[i][j] - K[i][0] * state_.P[0][j] - K[i][1] * state_.P[1][j];
+            }
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                state_.P[i][j] = 0.5 * (P[i][j] + P[j][i]);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * 预测任意时刻的状态
+     * @param t_ns 查询时刻（纳秒）；早于最后一次测量时返回最后一次更新后的状态
+     * @param out 预测状态及协方差
+     * @return 未初始化时返回false
+     */
+    bool ConstantVelocityKalman2D::predict(int64_t t_ns, State &out) const
+    {
+        if (!initialized_)
+        {
+            return false;
+        }
+        out = state_;
+        propagate(out, (t_ns - last_update_ns_) * 1e-9);
+        return true;
+    }
+
+    /**
+     * 重置滤波器，下一次测量重新初始化
+     */
+    void ConstantVelocityKalman2D::reset()
+    {
+        initialized_ = false;
+    }
+
     /*::::::::::::::::::::::::::::::::::::::::::::::::::::::::: 互补滤波器实现 :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::*/
     /**
      * 互补滤波器函数
@@ -0,0 +1,612 @@
+#include "mission_task.hpp"
+
+#include "action_executor.hpp"
+#include "fly_mission.hpp"
+#include "landing_state_machine.hpp"
+#include "offboard_session.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+using namespace mavsdk;
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    constexpr double TAKEOFF_ALTITUDE_RATIO = 0.9;  // 相对高度达到起飞高度的该比例即认为起飞完成
+    constexpr double TAKEOFF_CLIMB_TIMEOUT_S = 30.0; // 起飞命令完成后等待爬升的超时时间(s)
+    constexpr double MISSION_TIMEOUT_S = 300.0;      // 航点任务执行超时时间(s)
+    constexpr double MISSION_POLL_INTERVAL_S = 0.5;  // 查询航点任务是否完成的间隔(s)
+
+    // 距 since 经过的秒数
+    double secondsSince(const Clock::time_point &since)
+    {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    }
+
+    // future 是否已就绪（不等待）
+    bool isReady(const std::shared_future<ActionOutcome> &future)
+    {
+        return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // 取消本步骤交给动作执行器、尚未结束的动作（执行器同一时刻只执行一个动作，且只由控制线程提交）
+    void cancelAction(const std::shared_future<ActionOutcome> &future)
+    {
+        if (future.valid() && !isReady(future))
+        {
+            action_executor::Instance()->cancel();
+        }
+    }
+
+    /**
+     * @brief 异步调用的结果
+     *
+     * 由 MAVSDK 回调线程写入、控制线程读取。回调持有 shared_ptr，步骤被取消销毁后迟到的回调也不会访问已释放的内存。
+     * 步骤被取消时可以放弃本次调用并指定结果的善后处理，无论结果先到还是后到都只执行一次。
+     */
+    template <typename Result>
+    struct AsyncCall
+    {
+        std::atomic<bool> done{false};
+        std::atomic<Result> result{Result::Unknown};
+        std::atomic<bool> abandoned{false};   // 步骤已取消，结果由 on_abandoned 处理
+        std::atomic<bool> settled{false};     // on_abandoned 已执行
+        std::function<void(Result)> on_abandoned;
+
+        std::function<void(Result)> callback(const std::shared_ptr<AsyncCall> &self)
+        {
+            return [self](Result r)
+            {
+                self->result = r;
+                self->done = true;
+                if (self->abandoned && !self->settled.exchange(true))
+                {
+                    self->on_abandoned(r);
+                }
+            };
+        }
+
+        // 放弃本次调用（控制线程调用）：结果已到时立即在本线程处理，否则由回调线程在结果到达时处理
+        void abandon(std::function<void(Result)> handler)
+        {
+            on_abandoned = std::move(handler);
+            abandoned = true;
+            if (done && !settled.exchange(true))
+            {
+                on_abandoned(result);
+            }
+        }
+    };
+
+    /**
+     * @brief 起飞步骤：交给动作执行器解锁起飞，等待命令完成且相对高度达到起飞高度
+     *
+     * 执行器忙（例如上一次降落尚在上锁）时先等待其空闲再提交。
+     */
+    class TakeoffStep : public TaskStep
+    {
+    public:
+        explicit TakeoffStep(float altitude_m) : altitude_m_(altitude_m) {}
+
+        std::string name() const override { return "takeoff"; }
+
+        void start(Mavsdk_members &mavsdk) override
+        {
+            (void)mavsdk;
+            submitted_ = false;
+            climbing_ = false;
+        }
+
+        StepStatus poll(Mavsdk_members &mavsdk) override
+        {
+            if (!submitted_)
+            {
+                if (action_executor::Instance()->busy())
+                {
+                    return StepStatus::RUNNING;
+                }
+                future_ = arming_and_takeoff(mavsdk, altitude_m_);
+                submitted_ = true;
+            }
+
+            if (!climbing_)
+            {
+                if (!isReady(future_))
+                {
+                    return StepStatus::RUNNING;
+                }
+                const ActionOutcome outcome = future_.get();
+                if (!outcome.success)
+                {
+                    message_ = outcome.message;
+                    return StepStatus::FAILED;
+                }
+                climbing_ = true;
+                climb_start_ = Clock::now();
+            }
+
+            if (mavsdk.telemetry.position().relative_altitude_m >= altitude_m_ * TAKEOFF_ALTITUDE_RATIO)
+            {
+                message_ = "到达起飞高度";
+                return StepStatus::SUCCEEDED;
+            }
+            if (secondsSince(climb_start_) > TAKEOFF_CLIMB_TIMEOUT_S)
+            {
+                message_ = "等待到达起飞高度超时";
+                return StepStatus::FAILED;
+            }
+            return StepStatus::RUNNING;
+        }
+
+        void cancel(Mavsdk_members &mavsdk) override
+        {
+            (void)mavsdk;
+            cancelAction(future_);
+        }
+
+    private:
+        float altitude_m_;
+        bool submitted_ = false; // 是否已提交给动作执行器
+        bool climbing_ = false;  // 起飞命令已完成，等待爬升
+        Clock::time_point climb_start_;
+        std::shared_future<ActionOutcome> future_;
+    };
+
+    /**
+     * @brief 航点任务步骤：上传 → 解锁 → 开始任务 → 等待任务完成
+     *
+     * 每个阶段用 *_async 接口发出后在后续周期查询结果。取消时：
+     * - 上传阶段：上传不中止，航点只写入飞控而不会执行，下一次上传会覆盖它（上传尚未结束时新的上传可能因飞控忙而失败）；
+     * - 解锁阶段：已发出的解锁命令仍会完成，若此时飞行器仍在地面且没有新动作接管，则重新上锁，避免无人管理地保持解锁；
+     * - 开始任务及执行阶段：暂停任务（飞行器悬停，由新任务接管）。
+     */
+    class MissionStep : public TaskStep
+    {
+    public:
+        explicit MissionStep(std::string plan_file) : plan_file_(std::move(plan_file)) {}
+
+        std::string name() const override { return "mission"; }
+
+        void start(Mavsdk_members &mavsdk) override
+        {
+            const std::vector<Mission::MissionItem> items = load_mission_items(plan_file_);
+            if (items.empty())
+            {
+                phase_ = Phase::FAILED;
+                message_ = "读取任务航点失败: " + plan_file_;
+                return;
+            }
+
+            std::cout << "上传任务到无人机，共" << items.size() << "个航点..." << std::endl;
+            Mission::MissionPlan mission_plan{};
+            mission_plan.mission_items = items;
+            enter(Phase::UPLOADING);
+            mavsdk.mission.upload_mission_async(mission_plan, mission_call_->callback(mission_call_));
+        }
+
+        StepStatus poll(Mavsdk_members &mavsdk) override
+        {
+            switch (phase_)
+            {
+            case Phase::UPLOADING:
+                if (!mission_call_->done)
+                {
+                    return timedOut(10.0, "任务上传超时");
+                }
+                if (mission_call_->result != Mission::Result::Success)
+                {
+                    return fail("航线任务上传失败", mission_call_->result.load());
+                }
+                std::cout << "任务上传成功" << std::endl;
+                enter(Phase::WAIT_EXECUTOR);
+                [[fallthrough]];
+
+            case Phase::WAIT_EXECUTOR:
+                if (action_executor::Instance()->busy())
+                {
+                    return StepStatus::RUNNING; // 等待执行器中的起飞/降落结束，避免与其并发发出解锁命令
+                }
+                std::cout << "准备解锁..." << std::endl;
+                enter(Phase::ARMING);
+                mavsdk.action.arm_async(action_call_->callback(action_call_));
+                return StepStatus::RUNNING;
+
+            case Phase::ARMING:
+                if (!action_call_->done)
+                {
+                    return timedOut(10.0, "解锁超时");
+                }
+                if (action_call_->result != Action::Result::Success)
+                {
+                    return fail("解锁失败", action_call_->result.load());
+                }
+                offboard_session::Instance()->release(); // 主动切换到任务模式，结束offboard会话（不判为模式丢失）
+                std::cout << "开始航点任务..." << std::endl;
+                enter(Phase::STARTING);
+                mavsdk.mission.start_mission_async(mission_call_->callback(mission_call_));
+                return StepStatus::RUNNING;
+
+            case Phase::STARTING:
+                if (!mission_call_->done)
+                {
+                    return timedOut(10.0, "启动任务超时");
+                }
+                if (mission_call_->result != Mission::Result::Success)
+                {
+                    return fail("启动任务失败", mission_call_->result.load());
+                }
+                enter(Phase::FLYING);
+                return StepStatus::RUNNING;
+
+            case Phase::FLYING:
+            {
+                if (secondsSince(last_check_) < MISSION_POLL_INTERVAL_S)
+                {
+                    return StepStatus::RUNNING;
+                }
+                last_check_ = Clock::now();
+
+                // is_mission_finished() 读取插件缓存的任务进度，不等待飞控应答
+                const std::pair<Mission::Result, bool> finished = mavsdk.mission.is_mission_finished();
+                if (finished.first == Mission::Result::Success && finished.second)
+                {
+                    message_ = "任务已成功完成";
+                    return StepStatus::SUCCEEDED;
+                }
+                if (finished.first != Mission::Result::Success)
+                {
+                    std::cerr << "检查任务状态失败: " << finished.first << std::endl;
+                }
+                return timedOut(MISSION_TIMEOUT_S, "任务执行超时，未在指定时间内完成");
+            }
+
+            case Phase::FAILED:
+            default:
+                return StepStatus::FAILED;
+            }
+        }
+
+        void cancel(Mavsdk_members &mavsdk) override
+        {
+            if (phase_ == Phase::ARMING)
+            {
+                Action &action = mavsdk.action;
+                Telemetry &telemetry = mavsdk.telemetry;
+                action_call_->abandon([&action, &telemetry](Action::Result result)
+                                      { disarmOrphaned(action, telemetry, result); });
+            }
+            else if (phase_ == Phase::STARTING || phase_ == Phase::FLYING)
+            {
+                std::cout << "暂停航点任务" << std::endl;
+                mavsdk.mission.pause_mission_async([](Mission::Result result)
+                                                   {
+                                                       if (result != Mission::Result::Success)
+                                                       {
+                                                           std::cerr << "暂停任务失败: " << result << std::endl;
+                                                       } });
+            }
+        }
+
+    private:
+        enum class Phase
+        {
+            UPLOADING,     // 上传航点
+            WAIT_EXECUTOR, // 等待动作执行器空闲
+            ARMING,        // 解锁
+            STARTING,      // 开始任务
+            FLYING,        // 执行任务
+            FAILED,        // 失败
+        };
+
+        /**
+         * @brief 解锁阶段被取消后解锁命令的善后（在 MAVSDK 回调线程或控制线程中调用）
+         *
+         * 飞行器已离地或动作执行器正在执行新的起飞/降落时，飞行器已由新动作接管，不再上锁。
+         */
+        static void disarmOrphaned(Action &action, Telemetry &telemetry, Action::Result result)
+        {
+            if (result != Action::Result::Success)
+            {
+                return;
+            }
+            if (telemetry.in_air() || action_executor::Instance()->busy())
+            {
+                std::cout << "航点任务取消后解锁完成，飞行器已由新动作接管，保持解锁" << std::endl;
+                return;
+            }
+            std::cout << "航点任务在解锁阶段被取消，解锁完成后重新上锁" << std::endl;
+            action.disarm_async([](Action::Result r)
+                                {
+                                    if (r != Action::Result::Success)
+                                    {
+                                        std::cerr << "重新上锁失败，飞行器保持解锁: " << r << std::endl;
+                                    } });
+        }
+
+        // 进入阶段并清除上一次异步调用的结果
+        void enter(Phase phase)
+        {
+            phase_ = phase;
+            phase_start_ = Clock::now();
+            last_check_ = phase_start_;
+            mission_call_ = std::make_shared<AsyncCall<Mission::Result>>();
+            action_call_ = std::make_shared<AsyncCall<Action::Result>>();
+        }
+
+        // 当前阶段超时则失败，否则继续等待
+        StepStatus timedOut(double timeout_s, const char *text)
+        {
+            if (secondsSince(phase_start_) <= timeout_s)
+            {
+                return StepStatus::RUNNING;
+            }
+            phase_ = Phase::FAILED;
+            message_ = text;
+            return StepStatus::FAILED;
+        }
+
+        template <typename Result>
+        StepStatus fail(const char *text, Result result)
+        {
+            std::ostringstream oss;
+            oss << text << ": " << result;
+            phase_ = Phase::FAILED;
+            message_ = oss.str();
+            return StepStatus::FAILED;
+        }
+
+        std::string plan_file_;
+        Phase phase_ = Phase::UPLOADING;
+        Clock::time_point phase_start_; // 进入当前阶段的时刻
+        Clock::time_point last_check_;  // 上次查询任务是否完成的时刻
+        std::shared_ptr<AsyncCall<Mission::Result>> mission_call_ = std::make_shared<AsyncCall<Mission::Result>>();
+        std::shared_ptr<AsyncCall<Action::Result>> action_call_ = std::make_shared<AsyncCall<Action::Result>>();
+    };
+
+    /**
+     * @brief 视觉降落步骤：启动降落状态机，等待其交给自动降落并着地上锁
+     *
+     * 状态机本身仍由控制任务每周期调用 updateState() 推进，本步骤只观察其结果。
+     */
+    class VisionLandingStep : public TaskStep
+    {
+    public:
+        std::string name() const override { return "vision_landing"; }
+
+        void start(Mavsdk_members &mavsdk) override
+        {
+            (void)mavsdk;
+            landing_state_machine::Instance()->StartStateMachine();
+        }
+
+        StepStatus poll(Mavsdk_members &mavsdk) override
+        {
+            (void)mavsdk;
+            LandingStateMachine *machine = landing_state_machine::Instance();
+            if (machine->isRunning())
+            {
+                return StepStatus::RUNNING;
+            }
+
+            // 状态机结束：交给自动降落时停在 LANDING 并留下降落结果，其余（offboard 丢失等）回到 IDLE
+            const std::shared_future<ActionOutcome> future = machine->landFuture();
+            if (machine->getCurrentStateMachine() == LandingState::IDLE || !future.valid())
+            {
+                message_ = "视觉降落流程中止";
+                return StepStatus::FAILED;
+            }
+            if (!isReady(future))
+            {
+                return StepStatus::RUNNING;
+            }
+            const ActionOutcome outcome = future.get();
+            message_ = outcome.message;
+            return outcome.success ? StepStatus::SUCCEEDED : StepStatus::FAILED;
+        }
+
+        void cancel(Mavsdk_members &mavsdk) override
+        {
+            (void)mavsdk;
+            LandingStateMachine *machine = landing_state_machine::Instance();
+            machine->abort();
+            cancelAction(machine->landFuture()); // 已交给自动降落时一并取消
+        }
+    };
+
+    /**
+     * @brief 自动降落步骤：交给动作执行器降落并在着地后上锁
+     */
+    class LandStep : public TaskStep
+    {
+    public:
+        std::string name() const override { return "land"; }
+
+        void start(Mavsdk_members &mavsdk) override
+        {
+            (void)mavsdk;
+            submitted_ = false;
+        }
+
+        StepStatus poll(Mavsdk_members &mavsdk) override
+        {
+            if (!submitted_)
+            {
+                if (action_executor::Instance()->busy())
+                {
+                    return StepStatus::RUNNING;
+                }
+                future_ = land_and_disarm(mavsdk);
+                submitted_ = true;
+            }
+            if (!isReady(future_))
+            {
+                return StepStatus::RUNNING;
+            }
+            const ActionOutcome outcome = future_.get();
+            message_ = outcome.message;
+            return outcome.success ? StepStatus::SUCCEEDED : StepStatus::FAILED;
+        }
+
+        void cancel(Mavsdk_members &mavsdk) override
+        {
+            (void)mavsdk;
+            cancelAction(future_);
+        }
+
+    private:
+        bool submitted_ = false; // 是否已提交给动作执行器
+        std::shared_future<ActionOutcome> future_;
+    };
+}
+
+StepPtr takeoffStep(float altitude_m)
+{
+    return std::make_unique<TakeoffStep>(altitude_m);
+}
+
+StepPtr missionStep(const std::string &plan_file)
+{
+    return std::make_unique<MissionStep>(plan_file);
+}
+
+StepPtr visionLandingStep()
+{
+    return std::make_unique<VisionLandingStep>();
+}
+
+StepPtr landStep()
+{
+    return std::make_unique<LandStep>();
+}
+
+SequenceStep::SequenceStep(std::string name, std::vector<StepPtr> steps)
+    : name_(std::move(name)), steps_(std::move(steps))
+{
+}
+
+std::string SequenceStep::name() const
+{
+    if (index_ < steps_.size())
+    {
+        return name_ + " > " + steps_[index_]->name();
+    }
+    return name_;
+}
+
+void SequenceStep::start(Mavsdk_members &mavsdk)
+{
+    index_ = 0;
+    if (!steps_.empty())
+    {
+        steps_[0]->start(mavsdk);
+    }
+}
+
+StepStatus SequenceStep::poll(Mavsdk_members &mavsdk)
+{
+    while (index_ < steps_.size())
+    {
+        TaskStep &step = *steps_[index_];
+        const StepStatus status = step.poll(mavsdk);
+        if (status == StepStatus::RUNNING)
+        {
+            return StepStatus::RUNNING;
+        }
+
+        message_ = step.name() + ": " + step.message();
+        if (status == StepStatus::FAILED)
+        {
+            return StepStatus::FAILED;
+        }
+
+        // 续接：上一步完成后立即在本周期开始下一步
+        std::cout << "步骤完成: " << message_ << std::endl;
+        if (++index_ < steps_.size())
+        {
+            steps_[index_]->start(mavsdk);
+        }
+    }
+    return StepStatus::SUCCEEDED;
+}
+
+void SequenceStep::cancel(Mavsdk_members &mavsdk)
+{
+    if (index_ < steps_.size())
+    {
+        steps_[index_]->cancel(mavsdk);
+    }
+}
+
+// 提交任务
+void TaskEngine::submit(Mavsdk_members &mavsdk, const std::string &name, StepPtr task)
+{
+    if (task_)
+    {
+        cancel(mavsdk);
+    }
+    task_ = std::move(task);
+    name_ = name;
+    started_ = false;
+}
+
+// 取消正在执行的任务
+void TaskEngine::cancel(Mavsdk_members &mavsdk)
+{
+    if (!task_)
+    {
+        return;
+    }
+    if (started_)
+    {
+        task_->cancel(mavsdk);
+    }
+    report("任务取消: " + name_ + " (" + task_->name() + ")");
+    task_.reset();
+}
+
+// 推进正在执行的任务
+void TaskEngine::poll(Mavsdk_members &mavsdk)
+{
+    if (!task_)
+    {
+        return;
+    }
+    if (!started_)
+    {
+        started_ = true;
+        report("任务开始: " + name_);
+        task_->start(mavsdk);
+    }
+
+    const StepStatus status = task_->poll(mavsdk);
+    if (status == StepStatus::RUNNING)
+    {
+        return;
+    }
+    report((status == StepStatus::SUCCEEDED ? "任务完成: " : "任务失败: ") + name_ + " - " + task_->message());
+    task_.reset();
+}
+
+std::string TaskEngine::current() const
+{
+    return task_ ? name_ + " [" + task_->name() + "]" : "IDLE";
+}
+
+void TaskEngine::setReporter(std::function<void(const std::string &)> reporter)
+{
+    reporter_ = std::move(reporter);
+}
+
+// 报告任务进展
+void TaskEngine::report(const std::string &text)
+{
+    std::cout << text << std::endl;
+    if (reporter_)
+    {
+        reporter_(text);
+    }
+}
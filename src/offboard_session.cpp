@@ -0,0 +1,322 @@
+#include "offboard_session.hpp"
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace mavsdk;
+
+void SetpointSlot::write(const OffboardSetpoint &setpoint)
+{
+    const uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    type_.store(static_cast<uint32_t>(setpoint.type), std::memory_order_relaxed);
+    for (int i = 0; i < 4; ++i)
+    {
+        values_[i].store(setpoint.values[i], std::memory_order_relaxed);
+    }
+    stamp_ns_.store(setpoint.stamp_ns, std::memory_order_relaxed);
+
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+uint64_t SetpointSlot::read(OffboardSetpoint &setpoint) const
+{
+    for (;;)
+    {
+        const uint64_t begin = seq_.load(std::memory_order_acquire);
+        if (begin == 0)
+        {
+            return 0;
+        }
+        if (begin & 1)
+        {
+            std::this_thread::yield(); // 写者正在写入
+            continue;
+        }
+
+        OffboardSetpoint copy;
+        copy.type = static_cast<SetpointType>(type_.load(std::memory_order_relaxed));
+        for (int i = 0; i < 4; ++i)
+        {
+            copy.values[i] = values_[i].load(std::memory_order_relaxed);
+        }
+        copy.stamp_ns = stamp_ns_.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) == begin)
+        {
+            setpoint = copy;
+            return begin / 2;
+        }
+    }
+}
+
+OffboardSession::~OffboardSession()
+{
+    stop();
+}
+
+bool OffboardSession::start(Offboard &offboard, Telemetry &telemetry, const OffboardSessionParams &params)
+{
+    if (running_)
+    {
+        return false;
+    }
+
+    offboard_ = &offboard;
+    telemetry_ = &telemetry;
+    params_ = params;
+    if (params_.rate_hz < 20.0 || params_.rate_hz > 50.0)
+    {
+        std::cerr << "offboard 设定点发送频率 " << params_.rate_hz << "Hz 超出范围，限制在 20~50Hz" << std::endl;
+        params_.rate_hz = std::min(50.0, std::max(20.0, params_.rate_hz));
+    }
+
+    running_ = true;
+    thread_ = std::thread(&OffboardSession::streamLoop, this);
+    return true;
+}
+
+void OffboardSession::stop()
+{
+    running_ = false;
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+bool OffboardSession::publishPosition(float north_m, float east_m, float down_m, float yaw_deg)
+{
+    OffboardSetpoint setpoint;
+    setpoint.type = SetpointType::POSITION_NED;
+    setpoint.values[0] = north_m;
+    setpoint.values[1] = east_m;
+    setpoint.values[2] = down_m;
+    setpoint.values[3] = yaw_deg;
+    return publish(setpoint);
+}
+
+bool OffboardSession::publishBodyVelocity(float forward_m_s, float right_m_s, float down_m_s, float yawspeed_deg_s)
+{
+    OffboardSetpoint setpoint;
+    setpoint.type = SetpointType::VELOCITY_BODY;
+    setpoint.values[0] = forward_m_s;
+    setpoint.values[1] = right_m_s;
+    setpoint.values[2] = down_m_s;
+    setpoint.values[3] = yawspeed_deg_s;
+    return publish(setpoint);
+}
+
+/**
+ * @brief 发布设定点
+ * @param setpoint 设定点
+ * @return 会话可用返回true
+ *
+ * 只写无锁槽和几个原子标志，不做任何 MAVLink 往返。
+ */
+bool OffboardSession::publish(const OffboardSetpoint &setpoint)
+{
+    if (state_ == OffboardState::LOST)
+    {
+        return false;
+    }
+
+    OffboardSetpoint stamped = setpoint;
+    stamped.stamp_ns = steadyNowNs();
+    slot_.write(stamped);
+    published_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!engaged_.load(std::memory_order_relaxed))
+    {
+        engaged_ = true; // 首个设定点：请求发送线程接管
+    }
+    return true;
+}
+
+/**
+ * @brief 结束会话
+ *
+ * 只在锁内更新状态并递增会话代数，不等待发送线程中可能正在进行的 start() 往返（可能长达数秒）；
+ * 该请求返回后按代数判为过期，结果被丢弃，不会再进入 ACTIVE。
+ * 过期请求的模式切换命令在 release() 之前就已发出，调用者之后发出的模式命令晚于它到达飞控，以后者为准。
+ */
+void OffboardSession::release()
+{
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    ++epoch_;
+    engaged_ = false;
+    state_ = OffboardState::IDLE;
+}
+
+void OffboardSession::setModeLossCallback(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    mode_loss_callback_ = std::move(callback);
+}
+
+bool OffboardSession::send(const OffboardSetpoint &setpoint)
+{
+    Offboard::Result result;
+    if (setpoint.type == SetpointType::POSITION_NED)
+    {
+        Offboard::PositionNedYaw position_ned{};
+        position_ned.north_m = setpoint.values[0];
+        position_ned.east_m = setpoint.values[1];
+        position_ned.down_m = setpoint.values[2];
+        position_ned.yaw_deg = setpoint.values[3];
+        result = offboard_->set_position_ned(position_ned);
+    }
+    else
+    {
+        Offboard::VelocityBodyYawspeed velocity_body{};
+        velocity_body.forward_m_s = setpoint.values[0];
+        velocity_body.right_m_s = setpoint.values[1];
+        velocity_body.down_m_s = setpoint.values[2];
+        velocity_body.yawspeed_deg_s = setpoint.values[3];
+        result = offboard_->set_velocity_body(velocity_body);
+    }
+    return result == Offboard::Result::Success;
+}
+
+/**
+ * @brief 发送线程主循环
+ *
+ * 按固定频率（绝对时刻，不随发送耗时漂移）发出最新设定点，并推进会话状态：
+ * IDLE/STARTING 时请求进入 offboard（先发设定点再请求，飞控要求进入前已有设定点流），
+ * ACTIVE 时检查遥测飞行模式，连续不是 Offboard 即判为模式丢失。
+ */
+void OffboardSession::streamLoop()
+{
+    const auto period = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / params_.rate_hz));
+    const int64_t grace_ns = static_cast<int64_t>(params_.mode_grace_s * 1e9);
+    const int64_t retry_ns = static_cast<int64_t>(params_.retry_interval_s * 1e9);
+    const int64_t timeout_ns = static_cast<int64_t>(params_.setpoint_timeout_s * 1e9);
+
+    int64_t active_since_ns = 0; // 进入 offboard 的时刻
+    int64_t next_attempt_ns = 0; // 下一次允许请求进入 offboard 的时刻
+    auto next_tick = std::chrono::steady_clock::now();
+
+    while (running_)
+    {
+        next_tick = std::max(next_tick + period, std::chrono::steady_clock::now()); // 请求进入 offboard 阻塞期间错过的周期不补发
+        std::this_thread::sleep_until(next_tick);
+
+        if (!engaged_)
+        {
+            continue; // 未接管或已释放
+        }
+
+        OffboardSetpoint setpoint;
+        if (slot_.read(setpoint) == 0)
+        {
+            continue;
+        }
+
+        const int64_t now = steadyNowNs();
+        if (setpoint.type == SetpointType::VELOCITY_BODY && now - setpoint.stamp_ns > timeout_ns)
+        {
+            std::fill(setpoint.values, setpoint.values + 4, 0.0f); // 设定点过旧：悬停
+            stale_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (send(setpoint))
+        {
+            sent_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const OffboardState state = state_;
+        if (state == OffboardState::IDLE || state == OffboardState::STARTING)
+        {
+            if (now < next_attempt_ns)
+            {
+                continue;
+            }
+
+            uint64_t epoch = 0;
+            {
+                std::lock_guard<std::mutex> lock(command_mutex_);
+                if (!engaged_)
+                {
+                    continue; // 等锁期间已被释放
+                }
+                state_ = OffboardState::STARTING;
+                epoch = epoch_;
+            }
+
+            // 阻塞的命令往返不持锁，release() 不会因此等待
+            start_attempts_.fetch_add(1, std::memory_order_relaxed);
+            const Offboard::Result result = offboard_->start();
+
+            {
+                std::lock_guard<std::mutex> lock(command_mutex_);
+                if (epoch != epoch_)
+                {
+                    continue; // 请求期间会话已被释放：丢弃过期结果
+                }
+                if (result == Offboard::Result::Success)
+                {
+                    state_ = OffboardState::ACTIVE;
+                    active_since_ns = steadyNowNs();
+                    continue;
+                }
+                start_failures_.fetch_add(1, std::memory_order_relaxed);
+                next_attempt_ns = steadyNowNs() + retry_ns;
+            }
+            std::cerr << "offboard模式 启动失败: " << result << std::endl;
+        }
+        else if (state == OffboardState::ACTIVE && now - active_since_ns > grace_ns &&
+                 telemetry_->flight_mode() != Telemetry::FlightMode::Offboard)
+        {
+            {
+                std::lock_guard<std::mutex> lock(command_mutex_);
+                if (!engaged_ || state_ != OffboardState::ACTIVE)
+                {
+                    continue; // 期间已被主动释放
+                }
+                engaged_ = false;
+                state_ = OffboardState::LOST;
+            }
+            mode_losses_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "offboard模式 已丢失，当前飞行模式: " << telemetry_->flight_mode() << std::endl;
+
+            std::lock_guard<std::mutex> lock(callback_mutex_);
+            if (mode_loss_callback_)
+            {
+                mode_loss_callback_();
+            }
+        }
+    }
+}
+
+OffboardStats OffboardSession::stats() const
+{
+    OffboardStats stats;
+    stats.state = state_;
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.sent = sent_.load(std::memory_order_relaxed);
+    stats.stale = stale_.load(std::memory_order_relaxed);
+    stats.start_attempts = start_attempts_.load(std::memory_order_relaxed);
+    stats.start_failures = start_failures_.load(std::memory_order_relaxed);
+    stats.mode_losses = mode_losses_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string OffboardSession::stateToString(OffboardState state)
+{
+    switch (state)
+    {
+        case OffboardState::IDLE:
+            return "IDLE";
+        case OffboardState::STARTING:
+            return "STARTING";
+        case OffboardState::ACTIVE:
+            return "ACTIVE";
+        case OffboardState::LOST:
+            return "LOST";
+        default:
+            return "UNKNOWN";
+    }
+}
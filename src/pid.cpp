@@ -4,12 +4,19 @@
  * @brief PID控制器构造函数
  * 初始化控制器参数和状态
  */
-PID::PID() : is_first_detection_(true), current_step_(0)
+PID::PID() : metric_mode_(true), using_metric_(false), is_first_detection_(true), ramp_elapsed_s_(0.0), consumed_detect_ns_(0)
 {
     // 初始化PID参数
     pid_params_.kp = 0.002;
     pid_params_.ki = 0.0;
     pid_params_.kd = 0.0005;
+    pid_params_.integral_limit = 100.0;
+
+    // 米制参数：按3米高度、60°视场时的像素参数折算（1像素约5.4毫米），在任何高度下响应一致
+    metric_params_.kp = 0.4;
+    metric_params_.ki = 0.0;
+    metric_params_.kd = 0.1;
+    metric_params_.integral_limit = 2.0;
 
     // 初始化误差状态
     error_x_ = {};
@@ -22,7 +29,7 @@ PID::PID() : is_first_detection_(true), current_step_(0)
 
     // 初始化状态变量
     is_first_detection_ = true;
-    current_step_ = 0;
+    ramp_elapsed_s_ = 0.0;
 }
 
 /**
@@ -37,47 +44,68 @@ void PID::PID_update()
     {
         dt = 0.001; // 防止除零错误
     }
+    dt = std::min(dt, MAX_DT_S);
     pid_output_.timestamp = now;
 
-    First_Detection();      // 处理首次检测
-    apply_LowPass_Filter(); // 应用低通滤波
-    calculate_PID(dt);      // 计算PID控制量
+    consume_Landmark();       // 记录链路延迟
+    select_Units();           // 选择误差单位
+    First_Detection(dt);      // 处理首次检测
+    apply_LowPass_Filter(dt); // 应用低通滤波
+    calculate_PID(dt);        // 计算PID控制量
+}
+
+/**
+ * @brief 选择误差单位
+ * 地标带米制位置时按米制偏差控制，否则按像素偏差；单位变化时清空误差状态，避免滤波和积分混用两种单位
+ */
+void PID::select_Units()
+{
+    const bool metric = metric_mode_ && landmark_.pose_valid;
+    if (metric != using_metric_)
+    {
+        using_metric_ = metric;
+        error_x_ = {};
+        error_y_ = {};
+    }
+    pid_output_.metric = using_metric_;
 }
 
 /**
  * @brief 处理首次检测
- * 平滑过渡控制响应，避免突变
+ * @param dt 距上次更新的时间(秒)
+ * 平滑过渡控制响应，避免突变；渐进按时间计算，与控制频率无关
  */
-void PID::First_Detection()
+void PID::First_Detection(double dt)
 {
     if (is_first_detection_)
     {
         // 首次检测，使用渐进式控制避免突变
-        double ramp_factor = std::min(1.0, static_cast<double>(current_step_) / 100.0);
-        error_x_.current = landmark_.err_x * ramp_factor;
-        error_y_.current = landmark_.err_y * ramp_factor;
+        double ramp_factor = std::min(1.0, ramp_elapsed_s_ / RAMP_TIME_S);
+        error_x_.current = (using_metric_ ? landmark_.err_x_m : landmark_.err_x) * ramp_factor;
+        error_y_.current = (using_metric_ ? landmark_.err_y_m : landmark_.err_y) * ramp_factor;
 
-        current_step_++;
-        if (current_step_ >= 100)
+        ramp_elapsed_s_ += dt;
+        if (ramp_elapsed_s_ >= RAMP_TIME_S)
         {
             is_first_detection_ = false;
-            current_step_ = 0;
+            ramp_elapsed_s_ = 0.0;
         }
     }
     else
     {
-        error_x_.current = landmark_.err_x;
-        error_y_.current = landmark_.err_y;
+        error_x_.current = using_metric_ ? landmark_.err_x_m : landmark_.err_x;
+        error_y_.current = using_metric_ ? landmark_.err_y_m : landmark_.err_y;
     }
 }
 
 /**
  * @brief 应用低通滤波
- * 减少噪声影响，平滑控制响应
+ * @param dt 距上次更新的时间(秒)
+ * 减少噪声影响，平滑控制响应；滤波系数按时间常数和步长计算，与控制频率无关
  */
-void PID::apply_LowPass_Filter()
+void PID::apply_LowPass_Filter(double dt)
 {
-    static double alpha = 0.2; // 低通滤波系数
+    const double alpha = 1.0 - std::exp(-dt / FILTER_TAU_S); // 低通滤波系数
 
     // 保存上一时刻滤波值
     error_x_.last_filtered = error_x_.filtered;
@@ -94,26 +122,48 @@ void PID::apply_LowPass_Filter()
  */
 void PID::calculate_PID(double dt)
 {
+    const PIDParameters &params = using_metric_ ? metric_params_ : pid_params_;
+
     // 积分项累积
     error_x_.integral += error_x_.filtered * dt;
     error_y_.integral += error_y_.filtered * dt;
 
     // 限制积分项大小，防止积分饱和
-    error_x_.integral = std::max(std::min(error_x_.integral, 100.0), -100.0);
-    error_y_.integral = std::max(std::min(error_y_.integral, 100.0), -100.0);
+    error_x_.integral = std::max(std::min(error_x_.integral, params.integral_limit), -params.integral_limit);
+    error_y_.integral = std::max(std::min(error_y_.integral, params.integral_limit), -params.integral_limit);
 
     // 微分项计算（使用滤波后的值）
     error_x_.derivative = (error_x_.filtered - error_x_.last_filtered) / dt;
     error_y_.derivative = (error_y_.filtered - error_y_.last_filtered) / dt;
 
     // 计算最终控制输出
-    pid_output_.x = pid_params_.kp * error_x_.filtered +
-                    pid_params_.ki * error_x_.integral +
-                    pid_params_.kd * error_x_.derivative;
+    pid_output_.x = params.kp * error_x_.filtered +
+                    params.ki * error_x_.integral +
+                    params.kd * error_x_.derivative;
+
+    pid_output_.y = params.kp * error_y_.filtered +
+                    params.ki * error_y_.integral +
+                    params.kd * error_y_.derivative;
+}
+
+/**
+ * @brief 记录检测结果被控制器使用
+ * 同一检测结果（短时丢失时重复返回的旧结果）只在第一次使用时计入延迟统计
+ */
+void PID::consume_Landmark()
+{
+    if (landmark_.detect_end_ns == 0)
+    {
+        return; // 尚无检测结果
+    }
 
-    pid_output_.y = pid_params_.kp * error_y_.filtered +
-                    pid_params_.ki * error_y_.integral +
-                    pid_params_.kd * error_y_.derivative;
+    if (landmark_.detect_end_ns != consumed_detect_ns_)
+    {
+        consumed_detect_ns_ = landmark_.detect_end_ns;
+        pid_output_.consume_ns = steadyNowNs();
+        pipeline_latency::Instance()->recordConsumption(landmark_.capture_ns, landmark_.detect_end_ns, pid_output_.consume_ns);
+    }
+    pid_output_.capture_ns = landmark_.capture_ns;
 }
 
 /**
@@ -125,6 +175,15 @@ void PID::getLandmark(const AprilTagData &data)
     landmark_ = data;
 }
 
+/**
+ * @brief 设置是否按米制偏差控制
+ * @param enabled true 时地标带米制位置即按米制偏差和米制参数控制
+ */
+void PID::setMetricMode(bool enabled)
+{
+    metric_mode_ = enabled;
+}
+
 /**
  * @brief 输出PID控制结果
  */
@@ -135,10 +194,11 @@ PIDOutput PID::Output_PID() const
 
 /**
  * @brief 获取当前时间(秒)
+ * 使用单调时钟，与检测结果的时间戳一致，不受系统时间调整影响
  */
 double PID::get_current_time() const
 {
-    auto now = std::chrono::high_resolution_clock::now();
+    auto now = std::chrono::steady_clock::now();
     auto duration = now.time_since_epoch();
     return std::chrono::duration<double>(duration).count();
 }
\ No newline at end of file
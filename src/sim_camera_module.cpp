@@ -1,11 +1,21 @@
 #include "sim_camera_module.hpp"
+#include "color_convert.hpp"
+#include "frame_recorder.hpp"
+#include "latency_histogram.hpp"
 #include "mqtt_client.hpp"
 
+#include <gazebo/common/Image.hh>
+
 using namespace gazebo;
 
 // CGazebo_camera 类的定义
 // 构造函数初始化 running_ 和 stopped_ 标志，分别表示相机是否正在运行和是否已停止。
-CGazebo_camera::CGazebo_camera() : running_(false), stopped_(false) {}
+// 检测和显示各自订阅深度为1、丢弃旧帧的队列，互不争抢
+CGazebo_camera::CGazebo_camera() : running_(false), stopped_(false)
+{
+    detector_sub_ = frame_bus_.subscribe("detector", 1, DropPolicy::DROP_OLDEST);
+    display_sub_ = frame_bus_.subscribe("display", 1, DropPolicy::DROP_OLDEST);
+}
 
 // 析构函数调用 stop() 方法，确保在对象销毁时停止相机的运行。
 CGazebo_camera::~CGazebo_camera()
@@ -43,54 +53,118 @@ void CGazebo_camera::stop()
             display_thread_.join(); // 等待显示线程完成
         }
 
-        std::lock_guard<std::mutex> lock(queue_mutex_); // 使用互斥锁保护队列
-        stopped_ = true;                                // 设置停止标志为 true
-
-        queue_cond_.notify_all();   // 唤醒所有等待线程
+        stopped_ = true;            // 设置停止标志为 true
+        frame_bus_.close();         // 关闭所有订阅，唤醒等待帧的线程
         gazebo::client::shutdown(); // 关闭 Gazebo 客户端
     }
 }
 
-// 获取下一帧图像
-cv::Mat CGazebo_camera::GetNextFrame()
+// 设置图像接入模式
+void CGazebo_camera::setIngestMode(IngestMode mode)
 {
-    std::unique_lock<std::mutex> lock(queue_mutex_); // 使用互斥锁保护队列
+    ingest_mode_ = mode;
+}
 
-    // 等待直到队列非空或停止标志被设置
-    queue_cond_.wait(lock, [this]
-                     { return stopped_ || !frame_queue_.empty(); });
+// 获取帧池
+const FramePool &CGazebo_camera::framePool() const
+{
+    return frame_pool_;
+}
 
-    if (stopped_)
+// 获取下一帧图像
+CameraFrame CGazebo_camera::GetNextFrame()
+{
+    FramePtr frame;
+
+    // 等待直到有新帧或停止标志被设置
+    while (!stopped_)
     {
-        return cv::Mat(); // 如果已停止，返回空帧
+        if (detector_sub_->waitTake(frame, std::chrono::milliseconds(100)))
+        {
+            return *frame; // 返回最新的一帧（只复制引用）
+        }
     }
 
-    cv::Mat frame = frame_queue_.front(); // 获取队列中的第一帧
-    frame_queue_.pop();                   // 从队列中移除该帧
+    return CameraFrame(); // 如果已停止，返回空帧
+}
+
+// 限时获取下一帧图像
+bool CGazebo_camera::WaitNextFrame(FramePtr &frame, std::chrono::milliseconds timeout)
+{
+    return !stopped_ && detector_sub_->waitTake(frame, timeout);
+}
+
+// 获取被覆盖丢弃的帧数
+uint64_t CGazebo_camera::droppedFrames() const
+{
+    return detector_sub_->stats().dropped;
+}
 
-    return frame; // 返回获取的帧
+// 获取帧总线
+FrameBus &CGazebo_camera::frameBus()
+{
+    return frame_bus_;
 }
 
 // 图像回调函数
 void CGazebo_camera::ImageCallback(const boost::shared_ptr<const gazebo::msgs::ImageStamped> &_msg)
 {
+    const int64_t capture_ns = steadyNowNs(); // 收到图像的时刻，作为整条链路的起点
+
     const auto &img_msg = _msg->image(); // 获取图像消息
     const int width = img_msg.width();   // 获取图像宽度
     const int height = img_msg.height(); // 获取图像高度
     const int step = img_msg.step();     // 获取图像步长
+    uchar *data = const_cast<uchar *>(reinterpret_cast<const uchar *>(img_msg.data().data()));
 
-    cv::Mat frame(height, width, CV_8UC3, const_cast<uchar *>(reinterpret_cast<const uchar *>(img_msg.data().c_str())), step); // 将 Gazebo 图像数据转换为 OpenCV 的 cv::Mat 格式
-    cv::Mat bgr_frame;                                                                                                         // 定义 BGR 格式的图像
-    cv::cvtColor(frame, bgr_frame, cv::COLOR_RGB2BGR);                                                                         // 将 RGB 图像转换为 BGR 格式
+    // 持有消息本身，使原始数据视图在帧的生命周期内有效（零拷贝）
+    std::shared_ptr<const void> msg_holder(_msg.get(), [keep = _msg](const void *) {});
 
-    std::lock_guard<std::mutex> lock(queue_mutex_); // 使用互斥锁保护队列
-    if (frame_queue_.size() >= 2)
+    CameraFrame frame;
+    frame.sequence = ++frame_sequence_;
+    frame.capture_ns = capture_ns;
+    frame.sim_ns = static_cast<int64_t>(_msg->time().sec()) * 1000000000LL + _msg->time().nsec(); // 仿真渲染时刻
+
+    if (img_msg.pixel_format() == common::Image::L_INT8 || step == width)
     {
-        frame_queue_.pop(); // 如果队列中有超过 2 帧，移除最早的一帧
+        // 单通道图像直接引用消息数据，无需转换和复制
+        frame.gray = cv::Mat(height, width, CV_8UC1, data, step);
+        frame.gray_holder = msg_holder;
     }
+    else
+    {
+        const bool is_bgr = img_msg.pixel_format() == common::Image::BGR_INT8;
+        frame.color = cv::Mat(height, width, CV_8UC3, data, step); // 原始彩色数据视图
+        frame.color_format = is_bgr ? FramePixelFormat::BGR8 : FramePixelFormat::RGB8;
+        frame.color_holder = msg_holder;
 
-    frame_queue_.push(bgr_frame.clone()); // 将转换后的图像添加到队列中
-    queue_cond_.notify_one();             // 通知等待的消费者线程
+        if (ingest_mode_ == IngestMode::GRAY)
+        {
+            // 一次转换直接写入帧池中的灰度缓冲区（SIMD融合内核）
+            PooledImage gray = frame_pool_.acquire(height, width, CV_8UC1);
+            ColorConvert::toGray(frame.color, gray.mat, is_bgr ? ColorConvert::ChannelOrder::BGR : ColorConvert::ChannelOrder::RGB);
+            frame.gray = gray.mat;
+            frame.gray_holder = gray.holder;
+        }
+        else if (!is_bgr)
+        {
+            // 兼容模式：转换为 BGR 写入帧池缓冲区
+            PooledImage bgr = frame_pool_.acquire(height, width, CV_8UC3);
+            cv::cvtColor(frame.color, bgr.mat, cv::COLOR_RGB2BGR);
+            frame.color = bgr.mat;
+            frame.color_format = FramePixelFormat::BGR8;
+            frame.color_holder = bgr.holder;
+        }
+    }
+
+    // 发布后帧只读：所有消费者共享同一份帧，最后一个引用释放时缓冲区回到帧池
+    const FramePtr shared = std::make_shared<const CameraFrame>(std::move(frame));
+
+    // 录像只复制帧引用，像素由录像写线程写入文件
+    frame_recorder::Instance()->recordFrame(*shared);
+
+    // 广播到各订阅者的队列：队列满时按各自的策略丢帧，回调线程从不等待消费者
+    frame_bus_.publish(shared);
 }
 
 // 显示线程函数
@@ -106,15 +180,8 @@ void CGazebo_camera::DisplayThread()
     while (running_)
     {
         auto start = std::chrono::steady_clock::now(); // 获取当前时间
-        cv::Mat display_frame;                         // 定义用于显示的图像
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_); // 使用互斥锁保护队列
-            if (!frame_queue_.empty())
-            {
-                display_frame = frame_queue_.front(); // 获取队列中的第一帧
-                frame_queue_.pop();                   // 从队列中移除该帧
-            }
-        }
+        FramePtr display_frame;                        // 定义用于显示的图像
+        display_sub_->tryTake(display_frame);          // 从独立的显示订阅获取最新帧，不与检测线程争抢
 
         auto elapsed = std::chrono::steady_clock::now() - start; // 计算已过去的时间
         auto sleep_time = frame_duration - elapsed;              // 计算剩余时间
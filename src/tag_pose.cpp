@@ -0,0 +1,86 @@
+#include "tag_pose.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    constexpr double DEG_TO_RAD = M_PI / 180.0;
+}
+
+CameraIntrinsics CameraIntrinsics::fromHorizontalFov(int width, int height, double hfov_rad)
+{
+    CameraIntrinsics intrinsics;
+    if (width <= 0 || height <= 0 || hfov_rad <= 0.0 || hfov_rad >= M_PI)
+    {
+        return intrinsics;
+    }
+    intrinsics.fx = width / (2.0 * std::tan(hfov_rad / 2.0));
+    intrinsics.fy = intrinsics.fx;
+    intrinsics.cx = width / 2.0;
+    intrinsics.cy = height / 2.0;
+    return intrinsics;
+}
+
+bool estimateTagPose(const TagDetection &det, double tag_size_m, double offset_x_m, double offset_y_m,
+                     const CameraIntrinsics &intrinsics, const VehicleAttitude &attitude, TagPose &pose)
+{
+    pose = TagPose();
+    if (tag_size_m <= 0.0 || !intrinsics.valid())
+    {
+        return false;
+    }
+
+    // IPPE_SQUARE 要求的角点顺序与 AprilTag 一致：(-s/2, s/2), (s/2, s/2), (s/2, -s/2), (-s/2, -s/2)
+    const float half = static_cast<float>(tag_size_m / 2.0);
+    const std::vector<cv::Point3f> object_points = {
+        {-half, half, 0.0f},
+        {half, half, 0.0f},
+        {half, -half, 0.0f},
+        {-half, -half, 0.0f},
+    };
+    const std::vector<cv::Point2f> image_points(det.corners, det.corners + 4);
+
+    const cv::Matx33d camera_matrix(intrinsics.fx, 0.0, intrinsics.cx,
+                                    0.0, intrinsics.fy, intrinsics.cy,
+                                    0.0, 0.0, 1.0);
+    cv::Vec3d rvec, tvec;
+    if (!cv::solvePnP(object_points, image_points, camera_matrix, cv::noArray(), rvec, tvec, false, cv::SOLVEPNP_IPPE_SQUARE))
+    {
+        return false;
+    }
+    cv::Rodrigues(rvec, pose.rotation);
+
+    // 标签中心 → 着陆板中心：在标签平面内沿标签坐标轴反向平移偏移量
+    pose.camera = tvec + pose.rotation * cv::Vec3d(-offset_x_m, -offset_y_m, 0.0);
+    if (pose.camera[2] <= 0.0)
+    {
+        return false; // 解落在相机后方
+    }
+
+    // 相机系 → 机体系（前、右、下）
+    const double body_forward = -pose.camera[1];
+    const double body_right = pose.camera[0];
+    const double body_down = pose.camera[2];
+
+    // 机体系 → 水平坐标系：v_level = Ry(pitch) * Rx(roll) * v_body
+    const double roll = attitude.roll_deg * DEG_TO_RAD;
+    const double pitch = attitude.pitch_deg * DEG_TO_RAD;
+    const double cr = std::cos(roll), sr = std::sin(roll);
+    const double cp = std::cos(pitch), sp = std::sin(pitch);
+
+    const double y1 = cr * body_right - sr * body_down; // 先绕前向轴横滚
+    const double z1 = sr * body_right + cr * body_down;
+    pose.forward_m = cp * body_forward + sp * z1; // 再绕右向轴俯仰
+    pose.right_m = y1;
+    pose.down_m = -sp * body_forward + cp * z1;
+
+    // 水平坐标系 → NED：绕竖直轴偏航
+    const double yaw = attitude.yaw_deg * DEG_TO_RAD;
+    pose.north_m = std::cos(yaw) * pose.forward_m - std::sin(yaw) * pose.right_m;
+    pose.east_m = std::sin(yaw) * pose.forward_m + std::cos(yaw) * pose.right_m;
+
+    pose.m_per_px = pose.camera[2] / intrinsics.fx;
+    pose.valid = true;
+    return true;
+}
@@ -1,4 +1,6 @@
 #include "telemetry_monitor.hpp"
+#include "event_flags.hpp"
+
 #include <atomic>
 #include <chrono>
 #include <memory>
@@ -38,16 +40,22 @@ void TelemetryMonitor::monitorLoop()
     telemetry.subscribe_position(
         [this](Telemetry::Position position)
         {
-            std::lock_guard<std::mutex> lock(altitude_mutex_);
-            current_relative_altitude_m = position.relative_altitude_m;
+            {
+                std::lock_guard<std::mutex> lock(altitude_mutex_);
+                current_relative_altitude_m = position.relative_altitude_m;
+            }
+            control_events::Instance()->post(EVENT_TELEMETRY);
         });
 
     // 订阅位置数据
     telemetry.subscribe_position_velocity_ned(
         [this](Telemetry::PositionVelocityNed position_velocity_ned)
         {
-            std::lock_guard<std::mutex> lock(position_mutex_);
-            current_position = position_velocity_ned.position;
+            {
+                std::lock_guard<std::mutex> lock(position_mutex_);
+                current_position = position_velocity_ned.position;
+            }
+            control_events::Instance()->post(EVENT_TELEMETRY);
         });
 
     // 订阅飞行模式数据
@@ -82,8 +90,11 @@ void TelemetryMonitor::monitorLoop()
         telemetry.subscribe_attitude_euler(
             [this](Telemetry::EulerAngle attitude_euler)
             {
-                std::lock_guard<std::mutex> lock(euler_angle_mutex_);
-                m_euler_angle = attitude_euler;
+                {
+                    std::lock_guard<std::mutex> lock(euler_angle_mutex_);
+                    m_euler_angle = attitude_euler;
+                }
+                control_events::Instance()->post(EVENT_TELEMETRY);
             }));
 
     // 循环等待直到停止或检测到着陆
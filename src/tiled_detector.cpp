@@ -0,0 +1,218 @@
+#include "tiled_detector.hpp"
+
+#include "apriltag/tag25h9.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+TiledTagDetector::Worker::Worker()
+{
+    tf = tag25h9_create();
+    td = apriltag_detector_create();
+    if (!td || !tf)
+    {
+        throw std::runtime_error("未能创建 AprilTag 分块检测器");
+    }
+    apriltag_detector_add_family(td, tf);
+
+    // 与 AprilTagTracker 的检测器设置保持一致，并行度由分块提供
+    td->nthreads = 1;
+    td->refine_edges = true;
+    td->decode_sharpening = 0.75;
+}
+
+TiledTagDetector::Worker::~Worker()
+{
+    // 先释放检测器（会访问家族上的快速解码表），再释放标签家族
+    if (td)
+    {
+        apriltag_detector_destroy(td);
+    }
+    if (tf)
+    {
+        tag25h9_destroy(tf);
+    }
+    std::free(buffer);
+}
+
+TiledTagDetector::TiledTagDetector(const TileParams &params) : params_(params)
+{
+    params_.cols = std::max(1, params_.cols);
+    params_.rows = std::max(1, params_.rows);
+    params_.overlap_px = std::max(0, params_.overlap_px);
+    arena_.reset(new tbb::task_arena(params_.concurrency > 0 ? params_.concurrency : tbb::task_arena::automatic));
+}
+
+TiledTagDetector::~TiledTagDetector() = default;
+
+/**
+ * @brief 获取实际并行线程数
+ */
+int TiledTagDetector::concurrency() const
+{
+    return arena_->max_concurrency();
+}
+
+/**
+ * @brief 分块检测（分块在专用 task_arena 中并行，调用线程也参与执行）
+ */
+std::vector<TagDetection> TiledTagDetector::detect(const cv::Mat &gray, const cv::Rect &roi, const DetectorProfile &profile)
+{
+    const std::vector<cv::Rect> tiles = layoutTiles(roi);
+
+    tile_results_.resize(tiles.size());
+    for (std::vector<TagDetection> &results : tile_results_)
+    {
+        results.clear(); // 保留容量，稳态下不分配内存
+    }
+
+    arena_->execute([&]()
+                    { tbb::parallel_for(tbb::blocked_range<size_t>(0, tiles.size(), 1),
+                                        [&](const tbb::blocked_range<size_t> &range)
+                                        {
+                                            Worker &worker = workers_.local();
+                                            for (size_t i = range.begin(); i != range.end(); ++i)
+                                            {
+                                                detectTile(worker, gray, tiles[i], profile, tile_results_[i]);
+                                            }
+                                        }); });
+
+    return deduplicate(tile_results_);
+}
+
+/**
+ * @brief 计算分块位置
+ * @param roi 搜索区域
+ * @return 各分块（全帧坐标，相邻分块重叠 overlap_px）
+ *
+ * 每个分块的非重叠部分至少为重叠宽度的2倍，否则减少行列数，避免小区域被切得过碎。
+ */
+std::vector<cv::Rect> TiledTagDetector::layoutTiles(const cv::Rect &roi) const
+{
+    const int min_core = std::max(1, 2 * params_.overlap_px);
+    const int cols = std::max(1, std::min(params_.cols, roi.width / min_core));
+    const int rows = std::max(1, std::min(params_.rows, roi.height / min_core));
+    const int half = params_.overlap_px / 2;
+
+    std::vector<cv::Rect> tiles;
+    tiles.reserve(static_cast<size_t>(cols * rows));
+    for (int r = 0; r < rows; ++r)
+    {
+        const int y0 = roi.y + roi.height * r / rows;
+        const int y1 = roi.y + roi.height * (r + 1) / rows;
+        for (int c = 0; c < cols; ++c)
+        {
+            const int x0 = roi.x + roi.width * c / cols;
+            const int x1 = roi.x + roi.width * (c + 1) / cols;
+            cv::Rect tile(x0 - half, y0 - half, x1 - x0 + 2 * half, y1 - y0 + 2 * half);
+            tiles.push_back(tile & roi);
+        }
+    }
+    return tiles;
+}
+
+/**
+ * @brief 检测单个分块
+ * @param worker 当前线程的检测器
+ * @param gray 全帧灰度图
+ * @param tile 分块区域（全帧坐标）
+ * @param profile 检测器参数
+ * @param out 检测结果（全帧坐标）
+ *
+ * 分块统一复制到线程独占的对齐缓冲区：检测器可能对输入原地模糊，不能直接在共享的相机帧上检测。
+ */
+void TiledTagDetector::detectTile(Worker &worker, const cv::Mat &gray, const cv::Rect &tile,
+                                  const DetectorProfile &profile, std::vector<TagDetection> &out)
+{
+    const size_t stride = (static_cast<size_t>(tile.width) + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT;
+    const size_t bytes = stride * static_cast<size_t>(tile.height);
+    if (bytes > worker.capacity)
+    {
+        std::free(worker.buffer);
+        worker.buffer = static_cast<uint8_t *>(std::aligned_alloc(BUFFER_ALIGNMENT, bytes));
+        if (!worker.buffer)
+        {
+            worker.capacity = 0;
+            std::cerr << "无法分配分块检测缓冲区" << std::endl;
+            throw std::bad_alloc();
+        }
+        worker.capacity = bytes;
+    }
+
+    const cv::Mat region = gray(tile);
+    for (int y = 0; y < region.rows; ++y)
+    {
+        memcpy(worker.buffer + y * stride, region.ptr(y), region.cols);
+    }
+    image_u8_t image{tile.width, tile.height, static_cast<int32_t>(stride), worker.buffer};
+
+    // 参数每次按当前档位设置（只是字段赋值），档位切换无需重建检测器
+    worker.td->quad_decimate = profile.quad_decimate;
+    worker.td->quad_sigma = profile.quad_sigma;
+
+    zarray_t *detections = apriltag_detector_detect(worker.td, &image);
+    for (int i = 0; i < zarray_size(detections); ++i)
+    {
+        apriltag_detection_t *det;
+        zarray_get(detections, i, &det);
+
+        TagDetection tag;
+        tag.id = det->id;
+        tag.hamming = det->hamming;
+        tag.decision_margin = det->decision_margin;
+        tag.center = cv::Point2f(static_cast<float>(det->c[0] + tile.x), static_cast<float>(det->c[1] + tile.y));
+        for (int k = 0; k < 4; ++k)
+        {
+            tag.corners[k] = cv::Point2f(static_cast<float>(det->p[k][0] + tile.x), static_cast<float>(det->p[k][1] + tile.y));
+        }
+        out.push_back(tag);
+    }
+    apriltag_detections_destroy(detections);
+}
+
+/**
+ * @brief 合并各分块结果并去重
+ * @param per_tile 各分块的检测结果
+ * @return 去重后的检测结果：同一ID且中心距离小于半个边长的视为同一标签，保留解码置信度最高的一个
+ */
+std::vector<TagDetection> TiledTagDetector::deduplicate(const std::vector<std::vector<TagDetection>> &per_tile)
+{
+    std::vector<TagDetection> all;
+    for (const std::vector<TagDetection> &results : per_tile)
+    {
+        all.insert(all.end(), results.begin(), results.end());
+    }
+    std::stable_sort(all.begin(), all.end(), [](const TagDetection &a, const TagDetection &b)
+                     { return a.decision_margin > b.decision_margin; });
+
+    std::vector<TagDetection> kept;
+    kept.reserve(all.size());
+    for (const TagDetection &det : all)
+    {
+        const cv::Point2f diag = det.corners[2] - det.corners[0];
+        const float radius = std::max(4.0f, 0.35f * std::sqrt(diag.x * diag.x + diag.y * diag.y));
+
+        bool duplicate = false;
+        for (const TagDetection &other : kept)
+        {
+            const cv::Point2f d = other.center - det.center;
+            if (other.id == det.id && d.x * d.x + d.y * d.y < radius * radius)
+            {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate)
+        {
+            kept.push_back(det);
+        }
+    }
+    return kept;
+}
@@ -1,7 +1,8 @@
 #include "user_task.hpp"
 
+#include "event_flags.hpp"
 #include "fly_mission.hpp"
-#include "landing_state_machine.hpp"
+#include "mission_task.hpp"
 
 #include <cerrno>
 #include <chrono>
@@ -51,6 +52,13 @@ void handleTestMessage(const std::vector<unsigned char> &payload)
             std::cout << "收到航点任务命令，任务ID: " << missionID << std::endl;
             mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, "收到航点任务命令，ID: " + missionID);
         }
+        else if (command == "waypoint_landing")
+        {
+            user_task.waypoint_landing_task_flag = true;
+            user_task.mission_id = missionID; // 存储任务ID
+            std::cout << "收到航点任务后识别降落命令，任务ID: " << missionID << std::endl;
+            mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, "收到航点任务后识别降落命令，ID: " + missionID);
+        }
         else if (command == "land")
         {
             user_task.land_mode_flag = true;
@@ -62,6 +70,8 @@ void handleTestMessage(const std::vector<unsigned char> &payload)
             std::cout << "收到命令错误" << std::endl;
             mqtt_client::Instance()->sendMessage(REPLAY_TOPIC, "收到命令错误");
         }
+
+        control_events::Instance()->post(EVENT_COMMAND); // 唤醒控制线程立即执行命令
     }
     catch (const json::parse_error &e)
     {
@@ -70,33 +80,53 @@ void handleTestMessage(const std::vector<unsigned char> &payload)
     }
 }
 
-// 用户任务过程
+/**
+ * @brief 用户任务过程（在控制线程中每周期调用）
+ *
+ * 把收到的命令转换为任务提交给任务引擎（新命令取消正在执行的任务），再推进当前任务一步。
+ * 所有步骤都是非阻塞的，长时间的航点任务执行期间控制线程照常运行，并能随时响应新命令。
+ */
 void userTaskProcedure(Mavsdk_members &mavsdk)
 {
+    TaskEngine *engine = task_engine::Instance();
+
     if (user_task.takeoff_task_flag)
     {
         user_task.takeoff_task_flag = false;
         std::cout << "执行起飞任务" << std::endl;
-        arming_and_takeoff(mavsdk, 5.0);
+        engine->submit(mavsdk, "takeoff", takeoffStep(5.0f));
     }
 
     if (user_task.land_mode_flag)
     {
         user_task.land_mode_flag = false;
         std::cout << "执行降落模式任务" << std::endl;
-        land_and_disarm(mavsdk);
+        engine->submit(mavsdk, "land", landStep());
     }
 
     if (user_task.landing_task_flag)
     {
+        user_task.landing_task_flag = false;
         std::cout << "执行识别降落任务" << std::endl;
-        user_task.landing_task_flag = landing_state_machine::Instance()->StartStateMachine();
+        engine->submit(mavsdk, "landing", visionLandingStep());
     }
 
     if (user_task.waypoint_task_flag)
     {
         user_task.waypoint_task_flag = false;
         std::cout << "执行航点任务" << std::endl;
-        fly_mission(mavsdk, determine_mission_file_path(user_task.mission_id));
+        engine->submit(mavsdk, "waypoint", missionStep(determine_mission_file_path(user_task.mission_id)));
+    }
+
+    if (user_task.waypoint_landing_task_flag)
+    {
+        user_task.waypoint_landing_task_flag = false;
+        std::cout << "执行航点任务后识别降落" << std::endl;
+        engine->submit(mavsdk, "waypoint_landing",
+                       sequence("waypoint_landing",
+                                missionStep(determine_mission_file_path(user_task.mission_id)),
+                                visionLandingStep()));
     }
+
+    engine->poll(mavsdk);
 }
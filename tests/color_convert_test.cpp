@@ -0,0 +1,171 @@
+// 颜色转换内核逐位一致性测试
+//
+// 对本平台编译且CPU支持的每个指令集内核，在随机宽度（含非向量宽度整数倍的尾部）、带填充的行步长、
+// 两种通道顺序下，分别比对整幅转换、2x2 降采样转换和 ROI 转换与标量参考实现的输出，
+// 并检查行尾填充字节没有被改写。任一不一致时返回非零。
+
+#include "color_convert.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr uint8_t SENTINEL = 0xA5; // 目标缓冲区行尾填充的哨兵值
+    constexpr int RANDOM_TRIALS = 300; // 每个指令集的随机用例数
+
+    struct Context
+    {
+        std::mt19937 rng{20240611u};
+        int checks = 0;
+        int failures = 0;
+
+        int uniform(int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); }
+
+        void fill(std::vector<uint8_t> &buffer)
+        {
+            for (uint8_t &v : buffer)
+            {
+                v = static_cast<uint8_t>(rng());
+            }
+        }
+    };
+
+    // 比对两块目标缓冲区：有效区域逐字节相同，填充区域保持哨兵值
+    bool sameOutput(const std::vector<uint8_t> &ref, const std::vector<uint8_t> &out, size_t step, int width, int height)
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < step; ++x)
+            {
+                const size_t i = static_cast<size_t>(y) * step + x;
+                if (out[i] != ref[i] || (x >= static_cast<size_t>(width) && out[i] != SENTINEL))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void report(Context &ctx, bool ok, ColorConvert::Isa isa, const char *variant, int width, int height,
+                size_t src_step, size_t dst_step, ColorConvert::ChannelOrder order)
+    {
+        ++ctx.checks;
+        if (!ok)
+        {
+            ++ctx.failures;
+            std::printf("FAIL %s %s: %dx%d src_step %zu dst_step %zu %s\n", ColorConvert::isaName(isa), variant, width, height,
+                        src_step, dst_step, order == ColorConvert::ChannelOrder::RGB ? "RGB" : "BGR");
+        }
+    }
+
+    // 整幅转换和 2x2 降采样转换（指针接口，行步长带随机填充）
+    void checkPlanes(Context &ctx, ColorConvert::Isa isa, int width, int height, ColorConvert::ChannelOrder order)
+    {
+        const size_t src_step = static_cast<size_t>(width) * 3 + ctx.uniform(0, 37);
+        std::vector<uint8_t> src(src_step * height);
+        ctx.fill(src);
+
+        {
+            const size_t dst_step = static_cast<size_t>(width) + ctx.uniform(0, 19);
+            std::vector<uint8_t> ref(dst_step * height, SENTINEL), out(dst_step * height, SENTINEL);
+            ColorConvert::Reference::toGray(src.data(), src_step, ref.data(), dst_step, width, height, order);
+            ColorConvert::toGray(src.data(), src_step, out.data(), dst_step, width, height, order);
+            report(ctx, sameOutput(ref, out, dst_step, width, height), isa, "toGray", width, height, src_step, dst_step, order);
+        }
+
+        if (width >= 2 && height >= 2)
+        {
+            const int out_width = width / 2;
+            const int out_height = height / 2;
+            const size_t dst_step = static_cast<size_t>(out_width) + ctx.uniform(0, 19);
+            std::vector<uint8_t> ref(dst_step * out_height, SENTINEL), out(dst_step * out_height, SENTINEL);
+            ColorConvert::Reference::toGrayHalf(src.data(), src_step, ref.data(), dst_step, width, height, order);
+            ColorConvert::toGrayHalf(src.data(), src_step, out.data(), dst_step, width, height, order);
+            report(ctx, sameOutput(ref, out, dst_step, out_width, out_height), isa, "toGrayHalf", width, height, src_step, dst_step, order);
+        }
+    }
+
+    // ROI 转换：子区域视图的行步长为整幅图像的步长，起点不对齐
+    void checkRoi(Context &ctx, ColorConvert::Isa isa, int width, int height, ColorConvert::ChannelOrder order)
+    {
+        cv::Mat src(height, width, CV_8UC3);
+        for (int y = 0; y < height; ++y)
+        {
+            uint8_t *row = src.ptr<uint8_t>(y);
+            for (int x = 0; x < width * 3; ++x)
+            {
+                row[x] = static_cast<uint8_t>(ctx.rng());
+            }
+        }
+
+        const int x0 = ctx.uniform(0, width - 1);
+        const int y0 = ctx.uniform(0, height - 1);
+        const cv::Rect roi(x0, y0, ctx.uniform(1, width - x0), ctx.uniform(1, height - y0));
+
+        cv::Mat out;
+        ColorConvert::toGrayRoi(src, roi, out, order);
+
+        const cv::Mat region = src(roi);
+        std::vector<uint8_t> ref(static_cast<size_t>(roi.width) * roi.height);
+        ColorConvert::Reference::toGray(region.data, region.step, ref.data(), roi.width, roi.width, roi.height, order);
+
+        bool ok = out.rows == roi.height && out.cols == roi.width && out.type() == CV_8UC1;
+        for (int y = 0; ok && y < roi.height; ++y)
+        {
+            const uint8_t *row = out.ptr<uint8_t>(y);
+            ok = std::equal(row, row + roi.width, ref.begin() + static_cast<size_t>(y) * roi.width);
+        }
+        report(ctx, ok, isa, "toGrayRoi", roi.width, roi.height, region.step, static_cast<size_t>(roi.width), order);
+    }
+
+    void checkIsa(Context &ctx, ColorConvert::Isa isa)
+    {
+        for (ColorConvert::ChannelOrder order : {ColorConvert::ChannelOrder::RGB, ColorConvert::ChannelOrder::BGR})
+        {
+            // 覆盖 1..96 的每个宽度：包含各向量宽度（16/32 像素）的全部尾部长度
+            for (int width = 1; width <= 96; ++width)
+            {
+                checkPlanes(ctx, isa, width, ctx.uniform(1, 5), order);
+            }
+        }
+
+        for (int trial = 0; trial < RANDOM_TRIALS; ++trial)
+        {
+            const ColorConvert::ChannelOrder order = (trial & 1) ? ColorConvert::ChannelOrder::BGR : ColorConvert::ChannelOrder::RGB;
+            const int width = ctx.uniform(1, 700);
+            const int height = ctx.uniform(1, 12);
+            checkPlanes(ctx, isa, width, height, order);
+            checkRoi(ctx, isa, width, height, order);
+        }
+    }
+}
+
+int main()
+{
+    Context ctx;
+    for (ColorConvert::Isa isa : {ColorConvert::Isa::SCALAR, ColorConvert::Isa::SSE41, ColorConvert::Isa::AVX2, ColorConvert::Isa::NEON})
+    {
+        if (!ColorConvert::isaAvailable(isa))
+        {
+            std::printf("skip %s: 本平台未编译或CPU不支持\n", ColorConvert::isaName(isa));
+            continue;
+        }
+        if (!ColorConvert::setIsa(isa))
+        {
+            ++ctx.failures;
+            std::printf("FAIL %s: 运行时自检未通过\n", ColorConvert::isaName(isa));
+            continue;
+        }
+
+        const int failures_before = ctx.failures;
+        checkIsa(ctx, isa);
+        std::printf("%s %s\n", ctx.failures == failures_before ? "ok  " : "FAIL", ColorConvert::isaName(isa));
+    }
+
+    std::printf("%d checks, %d failures\n", ctx.checks, ctx.failures);
+    return ctx.failures == 0 ? 0 : 1;
+}
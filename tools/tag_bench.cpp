@@ -0,0 +1,634 @@
+/**
+ * @file tag_bench.cpp
+ * @brief AprilTag检测离线基准测试：回放录制的图像目录或视频文件，对比不同检测器参数
+ *
+ * 用法：
+ *   tag_bench <录像会话目录|图像目录|视频文件> [选项]
+ *
+ * 选项：
+ *   --config name:decimate=2,sigma=0,threads=4,roi=1,pyramid=1,tiles=4x2,gate=1,cascade=1,flow=5
+ *                                                       添加一组测试参数（可重复指定，未指定时使用内置对比组）
+ *   --repeat N                                          每组参数回放 N 遍（默认 1）
+ *   --warmup N                                          每组参数正式计时前预热的帧数（默认 10）
+ *   --max-frames N                                      最多加载 N 帧（默认不限）
+ *   --color                                             以BGR彩色图输入检测器（计入灰度转换耗时）
+ *   --pad FILE                                          加载着陆板布局（多标签时按布局选标签，见 LandingPad::load）
+ *   --calib FILE                                        加载相机标定（角点查表去畸变，见 CameraCalibration::load），并对比整帧 remap 的耗时
+ *
+ * 每组参数输出吞吐量、单帧耗时 p50/p95/p99、检测率以及角点抖动（同一ID标签相邻帧角点位移的均方根）。
+ * 录像会话目录（FrameRecorder 写出的 seg_*.rec）直接映射回放，不复制像素。
+ * 只依赖 OpenCV 和 AprilTag，不链接 Gazebo、MAVSDK、MQTT。
+ */
+
+#include "apriltag_tracker.hpp"
+#include "color_convert.hpp"
+#include "frame_recorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // 一组测试参数
+    struct BenchConfig
+    {
+        std::string name;      // 名称
+        float decimate = 1.0f; // 降采样倍数
+        float sigma = 0.0f;    // 高斯模糊标准差
+        int threads = 4;       // 检测器线程数（分块模式下为 task_arena 并行线程数）
+        bool roi = false;      // 是否启用区域跟踪
+        bool pyramid = false;  // 是否启用金字塔检测（粗检测倍数取 decimate，至少为2）
+        int tile_cols = 0;     // 分块列数（0表示不分块）
+        int tile_rows = 0;     // 分块行数
+        bool gate = false;     // 是否启用帧变化门控（复用未变化帧的检测结果）
+        bool cascade = false;  // 是否启用级联检测（搜索阶段先找候选区域）
+        int flow = 0;          // 光流跟踪时完整检测的间隔帧数（0表示每帧完整检测）
+    };
+
+    // 一组参数的测试结果
+    struct BenchResult
+    {
+        size_t frames = 0;           // 计时帧数
+        double total_ms = 0.0;       // 总耗时
+        double p50 = 0.0;            // 单帧耗时中位数(ms)
+        double p95 = 0.0;            // 单帧耗时95分位(ms)
+        double p99 = 0.0;            // 单帧耗时99分位(ms)
+        size_t detected = 0;         // 检测到标签的帧数
+        size_t reused = 0;           // 画面未变化、复用上一帧结果的帧数
+        size_t tracked = 0;          // 光流跟踪得到结果的帧数
+        CascadeStats cascade;        // 级联检测统计
+        double jitter_rms = 0.0;     // 角点抖动均方根(像素)
+        size_t jitter_samples = 0;   // 参与抖动统计的角点数
+    };
+
+    // 内置对比组：全分辨率 / 降采样 / 单线程 / 区域跟踪 / 金字塔 / 分块并行（与检测器内置多线程对比）
+    std::vector<BenchConfig> defaultConfigs()
+    {
+        return {
+            {"full", 1.0f, 0.2f, 4, false},
+            {"full+roi", 1.0f, 0.2f, 4, true},
+            {"dec1.5", 1.5f, 0.2f, 4, false},
+            {"dec2", 2.0f, 0.0f, 4, false},
+            {"dec2+roi", 2.0f, 0.0f, 4, true},
+            {"dec2-1t", 2.0f, 0.0f, 1, false},
+            {"dec3", 3.0f, 0.0f, 2, false},
+            {"pyr2", 2.0f, 0.0f, 4, false, true},
+            {"pyr2+roi", 2.0f, 0.0f, 4, true, true},
+            {"full-8t", 1.0f, 0.2f, 8, false},
+            {"tile4x2-4t", 1.0f, 0.2f, 4, false, false, 4, 2},
+            {"tile4x2-8t", 1.0f, 0.2f, 8, false, false, 4, 2},
+            {"dec2-tile-8t", 2.0f, 0.0f, 8, false, false, 4, 2},
+            {"dec2+roi+gate", 2.0f, 0.0f, 4, true, false, 0, 0, true},
+            {"full+cascade", 1.0f, 0.2f, 4, true, false, 0, 0, false, true},
+            {"dec2+cascade", 2.0f, 0.0f, 4, true, false, 0, 0, false, true},
+            {"dec2+roi+flow5", 2.0f, 0.0f, 4, true, false, 0, 0, false, false, 5},
+            {"full+roi+flow5", 1.0f, 0.2f, 4, true, false, 0, 0, false, false, 5},
+        };
+    }
+
+    /**
+     * @brief 解析 --config 参数
+     * @param text 形如 "name:decimate=2,sigma=0,threads=4,roi=1,pyramid=1,tiles=4x2,gate=1,cascade=1,flow=5"，名称可省略
+     * @param config 解析结果
+     * @return 解析成功返回true
+     */
+    bool parseConfig(const std::string &text, BenchConfig &config)
+    {
+        std::string body = text;
+        const size_t colon = text.find(':');
+        if (colon != std::string::npos)
+        {
+            config.name = text.substr(0, colon);
+            body = text.substr(colon + 1);
+        }
+        else
+        {
+            config.name = text;
+        }
+
+        size_t pos = 0;
+        while (pos < body.size())
+        {
+            size_t end = body.find(',', pos);
+            if (end == std::string::npos)
+            {
+                end = body.size();
+            }
+            const std::string item = body.substr(pos, end - pos);
+            pos = end + 1;
+
+            const size_t eq = item.find('=');
+            if (eq == std::string::npos)
+            {
+                std::cerr << "无效的参数项: " << item << std::endl;
+                return false;
+            }
+            const std::string key = item.substr(0, eq);
+            const std::string value = item.substr(eq + 1);
+            try
+            {
+                if (key == "decimate")
+                    config.decimate = std::stof(value);
+                else if (key == "sigma")
+                    config.sigma = std::stof(value);
+                else if (key == "threads")
+                    config.threads = std::stoi(value);
+                else if (key == "roi")
+                    config.roi = std::stoi(value) != 0;
+                else if (key == "pyramid")
+                    config.pyramid = std::stoi(value) != 0;
+                else if (key == "gate")
+                    config.gate = std::stoi(value) != 0;
+                else if (key == "cascade")
+                    config.cascade = std::stoi(value) != 0;
+                else if (key == "flow")
+                    config.flow = std::stoi(value);
+                else if (key == "tiles")
+                {
+                    // 形如 4x2（列x行）
+                    const size_t x = value.find('x');
+                    if (x == std::string::npos)
+                    {
+                        std::cerr << "分块参数应为 列x行: " << value << std::endl;
+                        return false;
+                    }
+                    config.tile_cols = std::stoi(value.substr(0, x));
+                    config.tile_rows = std::stoi(value.substr(x + 1));
+                }
+                else
+                {
+                    std::cerr << "未知参数: " << key << std::endl;
+                    return false;
+                }
+            }
+            catch (const std::exception &)
+            {
+                std::cerr << "参数值无效: " << item << std::endl;
+                return false;
+            }
+        }
+        return config.decimate >= 1.0f && config.threads >= 1 && config.tile_cols >= 0 && config.tile_rows >= 0;
+    }
+
+    // 判断文件是否为支持的图像格式
+    bool isImageFile(const fs::path &path)
+    {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" ||
+               ext == ".pgm" || ext == ".ppm" || ext == ".tif" || ext == ".tiff";
+    }
+
+    /**
+     * @brief 预先加载全部帧到内存（避免磁盘读取计入检测耗时）
+     * @param input 录像会话目录、图像目录（按文件名排序回放）或视频文件
+     * @param color true加载BGR彩色图，false加载灰度图
+     * @param max_frames 最多加载帧数（0表示不限）
+     * @param reader 录像读取器（录像帧直接引用其映射内存，须在回放结束前保持打开）
+     * @return 加载的帧，失败时为空
+     */
+    std::vector<cv::Mat> loadFrames(const std::string &input, bool color, size_t max_frames, FrameRecordReader &reader)
+    {
+        std::vector<cv::Mat> frames;
+        const auto full = [&]()
+        { return max_frames > 0 && frames.size() >= max_frames; };
+
+        if (FrameRecordReader::isRecording(input))
+        {
+            if (!reader.open(input))
+            {
+                std::cerr << "无法打开录像: " << input << std::endl;
+                return frames;
+            }
+            RecordView view;
+            while (!full() && reader.next(view))
+            {
+                if (view.type != RecordType::FRAME)
+                    continue;
+                if (color)
+                {
+                    cv::Mat bgr;
+                    cv::cvtColor(view.gray, bgr, cv::COLOR_GRAY2BGR);
+                    frames.push_back(bgr);
+                }
+                else
+                {
+                    frames.push_back(view.gray); // 零拷贝
+                }
+            }
+            return frames;
+        }
+
+        if (fs::is_directory(input))
+        {
+            std::vector<fs::path> files;
+            for (const auto &entry : fs::directory_iterator(input))
+            {
+                if (entry.is_regular_file() && isImageFile(entry.path()))
+                {
+                    files.push_back(entry.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+
+            for (const fs::path &file : files)
+            {
+                if (full())
+                    break;
+                cv::Mat img = cv::imread(file.string(), color ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
+                if (img.empty())
+                {
+                    std::cerr << "跳过无法读取的图像: " << file << std::endl;
+                    continue;
+                }
+                frames.push_back(img);
+            }
+            return frames;
+        }
+
+        cv::VideoCapture capture(input);
+        if (!capture.isOpened())
+        {
+            std::cerr << "无法打开输入: " << input << std::endl;
+            return frames;
+        }
+        cv::Mat img;
+        while (!full() && capture.read(img))
+        {
+            if (img.empty())
+                break;
+            // VideoCapture 复用内部缓冲区，必须复制
+            cv::Mat converted;
+            if (color == (img.channels() == 3))
+                converted = img.clone();
+            else if (color)
+                cv::cvtColor(img, converted, cv::COLOR_GRAY2BGR);
+            else
+                cv::cvtColor(img, converted, cv::COLOR_BGR2GRAY);
+            frames.push_back(converted);
+        }
+        return frames;
+    }
+
+    // 已排序数组的分位数（最近秩法）
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        if (sorted.empty())
+            return 0.0;
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        return sorted[rank - 1];
+    }
+
+    // 在检测结果中查找指定ID的标签
+    const TagDetection *findTag(const std::vector<TagDetection> &detections, int id)
+    {
+        for (const TagDetection &det : detections)
+        {
+            if (det.id == id)
+                return &det;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 用一组参数回放全部帧
+     * @param config 测试参数
+     * @param frames 预加载的帧
+     * @param repeat 回放遍数
+     * @param warmup 预热帧数
+     * @param pad 着陆板布局（为空时单标签模式）
+     * @param calib_file 相机标定文件（为空时不去畸变）
+     * @return 测试结果
+     */
+    BenchResult runConfig(const BenchConfig &config, const std::vector<cv::Mat> &frames, int repeat, size_t warmup,
+                          const std::vector<PadTag> &pad, const std::string &calib_file)
+    {
+        AprilTagTracker tracker;
+        tracker.setPadLayout(pad);
+        if (!calib_file.empty())
+        {
+            tracker.loadCalibration(calib_file);
+        }
+        tracker.setDetectorProfiles({{config.name, 0.0f, config.decimate, config.sigma, config.threads}});
+
+        RoiTrackingParams roi_params;
+        roi_params.enabled = config.roi;
+        tracker.setRoiTracking(roi_params);
+
+        PyramidParams pyramid_params;
+        pyramid_params.enabled = config.pyramid;
+        tracker.setPyramidMode(pyramid_params);
+
+        TileParams tile_params;
+        tile_params.enabled = config.tile_cols > 0 && config.tile_rows > 0;
+        tile_params.cols = config.tile_cols;
+        tile_params.rows = config.tile_rows;
+        tile_params.concurrency = config.threads;
+        tracker.setTileMode(tile_params);
+
+        ChangeGateParams gate_params;
+        gate_params.enabled = config.gate;
+        tracker.setChangeGate(gate_params);
+
+        CascadeParams cascade_params;
+        cascade_params.enabled = config.cascade;
+        tracker.setCascade(cascade_params);
+
+        FlowTrackingParams flow_params;
+        flow_params.enabled = config.flow > 1;
+        flow_params.detect_interval = config.flow;
+        tracker.setFlowTracking(flow_params);
+
+        // 预热：让检测器建立线程池、分配常驻缓冲区
+        for (size_t i = 0; i < warmup && i < frames.size(); ++i)
+        {
+            cv::Mat frame = frames[i];
+            tracker.detect(frame, false);
+        }
+
+        BenchResult result;
+        std::vector<double> latencies;
+        latencies.reserve(frames.size() * repeat);
+        double jitter_sq_sum = 0.0;
+
+        for (int r = 0; r < repeat; ++r)
+        {
+            // 每一遍都从全图搜索开始，相邻遍之间不统计抖动
+            tracker.resetTrack();
+            std::vector<TagDetection> previous;
+
+            for (const cv::Mat &src : frames)
+            {
+                cv::Mat frame = src;
+                const auto t0 = std::chrono::steady_clock::now();
+                const AprilTagData data = tracker.detect(frame, false);
+                const auto t1 = std::chrono::steady_clock::now();
+                latencies.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+
+                const std::vector<TagDetection> &current = tracker.lastDetections();
+                if (!current.empty())
+                {
+                    result.detected++;
+                }
+                if (data.tracked)
+                {
+                    result.tracked++;
+                }
+                if (data.reused)
+                {
+                    result.reused++;
+                    continue; // 复用帧的角点与上一帧完全相同，不计入抖动
+                }
+
+                // 角点抖动：同一ID标签在相邻两帧中的角点位移
+                for (const TagDetection &det : current)
+                {
+                    const TagDetection *prev = findTag(previous, det.id);
+                    if (prev == nullptr)
+                        continue;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        const cv::Point2f d = det.corners[i] - prev->corners[i];
+                        jitter_sq_sum += d.x * d.x + d.y * d.y;
+                        result.jitter_samples++;
+                    }
+                }
+                previous = current;
+            }
+        }
+
+        result.cascade = tracker.cascadeStats(); // 含预热帧
+        result.frames = latencies.size();
+        for (double ms : latencies)
+        {
+            result.total_ms += ms;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        result.p50 = percentile(latencies, 50.0);
+        result.p95 = percentile(latencies, 95.0);
+        result.p99 = percentile(latencies, 99.0);
+        if (result.jitter_samples > 0)
+        {
+            result.jitter_rms = std::sqrt(jitter_sq_sum / result.jitter_samples);
+        }
+        return result;
+    }
+
+    /**
+     * @brief 对比两种去畸变方式的耗时：整帧 remap 与只对角点查表
+     * @param calibration 相机标定
+     * @param frames 预加载的帧
+     */
+    void benchUndistort(CameraCalibration &calibration, const std::vector<cv::Mat> &frames)
+    {
+        using Clock = std::chrono::steady_clock;
+        const auto ms = [](Clock::duration d)
+        { return std::chrono::duration<double, std::milli>(d).count(); };
+
+        const Clock::time_point build_start = Clock::now();
+        if (!calibration.prepare(frames[0].size()))
+        {
+            return;
+        }
+        const double build_ms = ms(Clock::now() - build_start);
+
+        const size_t samples = std::min<size_t>(frames.size(), 100);
+        cv::Mat undistorted;
+        const Clock::time_point remap_start = Clock::now();
+        for (size_t i = 0; i < samples; ++i)
+        {
+            calibration.remap(frames[i], undistorted);
+        }
+        const double remap_ms = ms(Clock::now() - remap_start) / samples;
+
+        // 每个标签查表 5 个点（四个角点和中心）
+        TagDetection det;
+        det.center = cv::Point2f(frames[0].cols * 0.5f, frames[0].rows * 0.5f);
+        for (int k = 0; k < 4; ++k)
+        {
+            det.corners[k] = det.center + cv::Point2f(k == 1 || k == 2 ? 40.5f : -40.5f, k < 2 ? 40.5f : -40.5f);
+        }
+        const int lookups = 10000;
+        volatile float sink = 0.0f; // 防止查表被优化掉
+        const Clock::time_point lut_start = Clock::now();
+        for (int i = 0; i < lookups; ++i)
+        {
+            det.center.x += 0.01f;
+            sink = calibration.undistort(det).center.x;
+        }
+        const double lut_us = ms(Clock::now() - lut_start) * 1000.0 / lookups;
+        (void)sink;
+
+        std::printf("去畸变: 查找表生成 %.1f ms（一次）, 整帧 remap %.2f ms/帧, 角点查表 %.3f us/标签\n", build_ms, remap_ms, lut_us);
+    }
+
+    void printUsage(const char *prog)
+    {
+        std::cerr << "用法: " << prog << " <录像会话目录|图像目录|视频文件> [--config name:decimate=2,sigma=0,threads=4,roi=1,pyramid=1,tiles=4x2,gate=1,cascade=1,flow=5]..."
+                  << " [--repeat N] [--warmup N] [--max-frames N] [--color] [--pad FILE] [--calib FILE]" << std::endl;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string input;
+    std::vector<BenchConfig> configs;
+    int repeat = 1;
+    size_t warmup = 10;
+    size_t max_frames = 0;
+    bool color = false;
+    std::string pad_file;
+    std::string calib_file;
+
+    // 解析命令行参数
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        try
+        {
+            if (arg == "--config" && has_value)
+            {
+                BenchConfig config;
+                if (!parseConfig(argv[++i], config))
+                {
+                    std::cerr << "无效的 --config: " << argv[i] << std::endl;
+                    return 1;
+                }
+                configs.push_back(config);
+            }
+            else if (arg == "--repeat" && has_value)
+                repeat = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--warmup" && has_value)
+                warmup = std::stoul(argv[++i]);
+            else if (arg == "--max-frames" && has_value)
+                max_frames = std::stoul(argv[++i]);
+            else if (arg == "--color")
+                color = true;
+            else if (arg == "--pad" && has_value)
+                pad_file = argv[++i];
+            else if (arg == "--calib" && has_value)
+                calib_file = argv[++i];
+            else if (arg == "-h" || arg == "--help")
+            {
+                printUsage(argv[0]);
+                return 0;
+            }
+            else if (input.empty() && arg.rfind("--", 0) != 0)
+                input = arg;
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "参数值无效: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (input.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (configs.empty())
+    {
+        configs = defaultConfigs();
+    }
+
+    LandingPad pad;
+    if (!pad_file.empty() && !pad.load(pad_file))
+    {
+        return 1;
+    }
+    CameraCalibration calibration;
+    if (!calib_file.empty() && !calibration.load(calib_file))
+    {
+        return 1;
+    }
+
+    FrameRecordReader reader;
+    const std::vector<cv::Mat> frames = loadFrames(input, color, max_frames, reader);
+    if (frames.empty())
+    {
+        std::cerr << "没有可回放的帧: " << input << std::endl;
+        return 1;
+    }
+
+    std::printf("输入: %s  帧数: %zu  尺寸: %dx%d  %s  重复: %d  预热: %zu\n",
+                input.c_str(), frames.size(), frames[0].cols, frames[0].rows,
+                color ? "BGR" : "GRAY", repeat, warmup);
+    if (color)
+    {
+        std::printf("灰度转换内核: %s\n", ColorConvert::isaName(ColorConvert::activeIsa()));
+    }
+    if (calibration.loaded())
+    {
+        benchUndistort(calibration, frames);
+    }
+    std::printf("%-12s %5s %5s %3s %4s %4s %5s | %8s %8s %8s %8s | %7s %8s %7s %9s\n",
+                "config", "dec", "sigma", "thr", "roi", "pyr", "tiles", "fps", "p50(ms)", "p95(ms)", "p99(ms)", "det(%)", "reuse(%)", "trk(%)", "jitter(px)");
+
+    for (const BenchConfig &config : configs)
+    {
+        char tiles[16] = "-";
+        if (config.tile_cols > 0 && config.tile_rows > 0)
+        {
+            std::snprintf(tiles, sizeof(tiles), "%dx%d", config.tile_cols, config.tile_rows);
+        }
+
+        BenchResult r;
+        try
+        {
+            r = runConfig(config, frames, repeat, warmup, pad.tags(), calib_file);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << config.name << ": " << e.what() << std::endl;
+            return 1;
+        }
+
+        const double fps = r.total_ms > 0.0 ? r.frames * 1000.0 / r.total_ms : 0.0;
+        const double det_rate = r.frames > 0 ? 100.0 * r.detected / r.frames : 0.0;
+        const double reuse_rate = r.frames > 0 ? 100.0 * r.reused / r.frames : 0.0;
+        const double track_rate = r.frames > 0 ? 100.0 * r.tracked / r.frames : 0.0;
+        std::printf("%-12s %5.2f %5.2f %3d %4s %4s %5s | %8.1f %8.2f %8.2f %8.2f | %7.1f %8.1f %7.1f ",
+                    config.name.c_str(), config.decimate, config.sigma, config.threads, config.roi ? "on" : "off", config.pyramid ? "on" : "off", tiles,
+                    fps, r.p50, r.p95, r.p99, det_rate, reuse_rate, track_rate);
+        if (r.jitter_samples > 0)
+            std::printf("%9.3f\n", r.jitter_rms);
+        else
+            std::printf("%9s\n", "-");
+
+        if (config.cascade && r.cascade.frames > 0)
+        {
+            // 第一级：拒绝率越高越省，区域命中率反映误检，抽检漏检反映是否损失了检测距离
+            const CascadeStats &c = r.cascade;
+            std::printf("%-12s cascade: rejected %.1f%%, regions %llu (hit %.1f%%), fallbacks %llu, audit misses %llu/%llu\n", "",
+                        100.0 * c.rejected / c.frames, static_cast<unsigned long long>(c.regions),
+                        c.regions > 0 ? 100.0 * c.region_hits / c.regions : 0.0, static_cast<unsigned long long>(c.fallbacks),
+                        static_cast<unsigned long long>(c.audit_misses), static_cast<unsigned long long>(c.audits));
+        }
+    }
+
+    return 0;
+}